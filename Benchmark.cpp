@@ -0,0 +1,448 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "MSTFactory.cpp"
+#include "GraphGenerator.cpp"
+#include "SolverWorkspace.cpp"
+#include "ThreadPool.cpp"
+#include "EdgeKernels.cpp"
+
+// Solver benchmark: runs every MSTFactory algorithm over a sweep of reproducible synthetic graphs
+// and prints one JSON document with, per (graph, algorithm): median and best time, ns per edge,
+// peak RSS and allocation counts. Solves run as tasks on a ThreadPool, the way the server runs
+// them, on a compacted CSR graph built before the clock starts.
+// Every result sits on its own line, so a later run can read it back as a baseline
+// (--baseline old.json) and fail when an algorithm got slower than the tolerance allows.
+
+// Every heap allocation in the process is counted, whichever thread makes it
+static std::atomic<uint64_t> heapAllocations(0);
+static std::atomic<uint64_t> heapBytes(0);
+
+static void* countedAllocation(size_t size, size_t alignment) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    heapBytes.fetch_add(size, std::memory_order_relaxed);
+    void* p = nullptr;
+    if (alignment <= alignof(std::max_align_t))
+        p = malloc(size == 0 ? 1 : size);
+    else if (posix_memalign(&p, alignment, size == 0 ? 1 : size) != 0)
+        p = nullptr;
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size) {
+    return countedAllocation(size, alignof(std::max_align_t));
+}
+
+void* operator new[](size_t size) {
+    return countedAllocation(size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return countedAllocation(size, size_t(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return countedAllocation(size, size_t(alignment));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return countedAllocation(size, alignof(std::max_align_t));
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    free(p);
+}
+
+class Benchmark {
+public:
+    struct Options {
+        std::vector<std::string> families = {"uniform", "grid", "rmat", "complete"};
+        std::vector<std::string> algorithms = MSTFactory::algorithms();
+        std::vector<std::string> weights = {"int", "real"};
+        size_t maxEdges = size_t(1) << 22;  // Larger cases of the sweep are skipped
+        int repeat = 3;
+        uint64_t seed = 42;
+        size_t numThreads = std::thread::hardware_concurrency();
+        std::string baseline;   // Earlier output to compare against
+        double tolerance = 0.10;  // Slowdown in ns/edge that counts as a regression
+    };
+
+    // One measured (graph, algorithm) pair
+    struct Result {
+        std::string family;
+        std::string weights;
+        std::string algorithm;
+        int numVertices = 0;
+        size_t numEdges = 0;
+        size_t forestEdges = 0;
+        double totalWeight = 0.0;
+        double medianSeconds = 0.0;
+        double bestSeconds = 0.0;
+        long peakRssKb = -1;    // Process peak during the solves, graph storage included
+        long rssGrowthKb = -1;  // Peak above the resident size before the solves
+        uint64_t firstAllocations = 0, firstBytes = 0;    // First solve on this graph
+        uint64_t steadyAllocations = 0, steadyBytes = 0;  // Last solve, with warm workspaces
+        uint64_t arenaAllocations = 0;                    // Workspace arena requests, last solve
+
+        double nsPerEdge() const {
+            return numEdges == 0 ? 0.0 : medianSeconds * 1e9 / double(numEdges);
+        }
+
+        std::string key() const {
+            return family + "/" + weights + "/" + std::to_string(numVertices) + "/" + std::to_string(numEdges) + "/" +
+                   algorithm;
+        }
+    };
+
+    explicit Benchmark(const Options& options) : options(options), pool(options.numThreads) {}
+
+    // Runs the sweep, writes the JSON to out and returns the process exit status:
+    // 1 if algorithms disagree on a forest's weight, 2 if a result regressed against the baseline
+    int run(std::ostream& out) {
+        std::map<std::string, double> baseline = loadBaseline();
+        int status = 0;
+        out << "{\n  \"seed\": " << options.seed << ",\n  \"threads\": " << pool.size() << ",\n  \"kernels\": \""
+            << EdgeKernels::name(EdgeKernels::level()) << "\",\n  \"compiler\": \"" << __VERSION__
+            << "\",\n  \"timestamp\": " << time(nullptr) << ",\n  \"results\": [";
+        bool first = true;
+
+        for (const std::string& weights : options.weights) {
+            for (const std::string& family : options.families) {
+                int vertices, parameter;
+                size_t edges;
+                for (size_t index = 0; sweep(family, index, vertices, parameter, edges); ++index) {
+                    if (edges > options.maxEdges)
+                        continue;
+                    // Every graph depends only on the seed and its own parameters
+                    GraphGenerator generator(options.seed, weights == "real" ? GraphGenerator::UnitReals
+                                                                             : GraphGenerator::SmallIntegers);
+                    GeneratedGraph graph = generate(generator, family, vertices, parameter, edges);
+                    CSRGraph csr(graph.numVertices, graph.view(), CSRGraph::LastRecordWins);  // As the server loads it
+                    csr.compact();
+                    double expectedWeight = NAN;
+                    for (const std::string& algorithm : options.algorithms) {
+                        Result result = measure(graph, csr, weights, algorithm);
+                        out << (first ? "\n" : ",\n") << "    " << json(result);
+                        out.flush();
+                        first = false;
+
+                        if (std::isnan(expectedWeight)) {
+                            expectedWeight = result.totalWeight;
+                        } else if (std::fabs(result.totalWeight - expectedWeight) > 1e-9 * std::fabs(expectedWeight)) {
+                            std::cerr << "MISMATCH " << result.key() << ": weight " << result.totalWeight
+                                      << ", expected " << expectedWeight << std::endl;
+                            status = 1;
+                        }
+                        auto previous = baseline.find(result.key());
+                        if (previous != baseline.end() && result.nsPerEdge() > previous->second * (1 + options.tolerance)) {
+                            std::cerr << "REGRESSION " << result.key() << ": " << result.nsPerEdge()
+                                      << " ns/edge, baseline " << previous->second << std::endl;
+                            if (status == 0)
+                                status = 2;
+                        }
+                    }
+                }
+            }
+        }
+        out << "\n  ]\n}" << std::endl;
+        return status;
+    }
+
+private:
+    Options options;
+    ThreadPool pool;
+    std::mutex jobMutex;
+    std::condition_variable jobFinished;
+    bool jobDone = false;
+
+    // Graph number `index` of a family's sweep over sizes and densities: vertex count, family
+    // parameter (average degree, grid side, RMAT scale) and edge count, or false past the last one
+    static bool sweep(const std::string& family, size_t index, int& vertices, int& parameter, size_t& edges) {
+        if (family == "uniform") {
+            static const int scales[] = {12, 12, 16, 16, 20, 20};
+            static const int degrees[] = {4, 32, 4, 32, 4, 32};
+            if (index >= 6)
+                return false;
+            vertices = 1 << scales[index];
+            parameter = degrees[index];
+            edges = size_t(vertices) * parameter / 2;
+        } else if (family == "grid") {
+            static const int sides[] = {64, 256, 1024, 2048};
+            if (index >= 4)
+                return false;
+            parameter = sides[index];
+            vertices = parameter * parameter;
+            edges = size_t(2) * parameter * (parameter - 1);
+        } else if (family == "rmat") {
+            static const int scales[] = {12, 12, 16, 16, 20, 20};
+            static const int edgeFactors[] = {8, 32, 8, 32, 8, 32};  // Edges per vertex
+            if (index >= 6)
+                return false;
+            parameter = scales[index];
+            vertices = 1 << parameter;
+            edges = size_t(vertices) * edgeFactors[index];
+        } else if (family == "complete") {
+            static const int sizes[] = {64, 512, 2048, 4096};
+            if (index >= 4)
+                return false;
+            vertices = parameter = sizes[index];
+            edges = size_t(vertices) * (vertices - 1) / 2;
+        } else {
+            throw std::invalid_argument("unknown graph family " + family);
+        }
+        return true;
+    }
+
+    static GeneratedGraph generate(GraphGenerator& generator, const std::string& family, int vertices, int parameter,
+                                   size_t edges) {
+        if (family == "uniform")
+            return generator.uniform(vertices, edges);
+        if (family == "grid")
+            return generator.grid(parameter, parameter);
+        if (family == "rmat")
+            return generator.rmat(parameter, edges);
+        return generator.complete(vertices);
+    }
+
+    // Runs fn as a pool task and waits for it
+    void onPool(const std::function<void()>& fn) {
+        struct Job : Task {
+            const std::function<void()>& fn;
+            Benchmark& owner;
+
+            Job(const std::function<void()>& fn, Benchmark& owner) : fn(fn), owner(owner) {}
+
+            void execute() override {
+                fn();
+                std::lock_guard<std::mutex> lock(owner.jobMutex);
+                owner.jobDone = true;
+                owner.jobFinished.notify_one();
+            }
+        };
+
+        jobDone = false;
+        pool.enqueue(new Job(fn, *this));  // The pool deletes it after execute()
+        std::unique_lock<std::mutex> lock(jobMutex);
+        jobFinished.wait(lock, [this] { return jobDone; });
+    }
+
+    Result measure(const GeneratedGraph& graph, const CSRGraph& csr, const std::string& weights,
+                   const std::string& algorithm) {
+        Result result;
+        result.family = graph.family;
+        result.weights = weights;
+        result.algorithm = algorithm;
+        result.numVertices = graph.numVertices;
+        result.numEdges = csr.numEdges();  // Distinct edges, after repeated pairs collapsed
+
+        std::unique_ptr<IMSTSolver> solver = MSTFactory::createSolver(algorithm);
+        MSTResult mst;
+        long rssBefore = residentKb("VmRSS:");
+        resetPeakRss();
+
+        // All repeats in one task, so they share a worker and its workspace: the first solve
+        // shows the cold allocations, the last one the steady state
+        std::vector<double> seconds;
+        onPool([&] {
+            const SolverWorkspace::Counters& workspace = SolverWorkspace::local().counters();
+            for (int r = 0; r < std::max(options.repeat, 1); ++r) {
+                uint64_t arenaBefore = workspace.arenaAllocations;
+                uint64_t allocationsBefore = heapAllocations.load(), bytesBefore = heapBytes.load();
+                auto start = std::chrono::steady_clock::now();
+                solver->solve(csr, mst);
+                auto end = std::chrono::steady_clock::now();
+                seconds.push_back(std::chrono::duration<double>(end - start).count());
+
+                uint64_t allocations = heapAllocations.load() - allocationsBefore;
+                uint64_t bytes = heapBytes.load() - bytesBefore;
+                if (r == 0) {
+                    result.firstAllocations = allocations;
+                    result.firstBytes = bytes;
+                }
+                result.steadyAllocations = allocations;
+                result.steadyBytes = bytes;
+                result.arenaAllocations = workspace.arenaAllocations - arenaBefore;
+            }
+        });
+
+        std::sort(seconds.begin(), seconds.end());
+        result.medianSeconds = seconds[seconds.size() / 2];
+        result.bestSeconds = seconds.front();
+        result.forestEdges = mst.edges.size();
+        result.totalWeight = mst.totalWeight;
+        result.peakRssKb = residentKb("VmHWM:");
+        if (result.peakRssKb >= 0 && rssBefore >= 0)
+            result.rssGrowthKb = std::max(0L, result.peakRssKb - rssBefore);
+        return result;
+    }
+
+    static std::string json(const Result& result) {
+        char text[1024];
+        snprintf(text, sizeof(text),
+                 "{\"family\": \"%s\", \"weights\": \"%s\", \"vertices\": %d, \"edges\": %zu, \"algorithm\": \"%s\", "
+                 "\"median_s\": %.9f, \"best_s\": %.9f, \"ns_per_edge\": %.3f, \"forest_edges\": %zu, "
+                 "\"total_weight\": %.17g, \"peak_rss_kb\": %ld, \"rss_growth_kb\": %ld, "
+                 "\"first_allocations\": %llu, \"first_bytes\": %llu, \"steady_allocations\": %llu, "
+                 "\"steady_bytes\": %llu, \"arena_allocations\": %llu, \"key\": \"%s\"}",
+                 result.family.c_str(), result.weights.c_str(), result.numVertices, result.numEdges,
+                 result.algorithm.c_str(), result.medianSeconds, result.bestSeconds, result.nsPerEdge(),
+                 result.forestEdges, result.totalWeight, result.peakRssKb, result.rssGrowthKb,
+                 (unsigned long long)result.firstAllocations, (unsigned long long)result.firstBytes,
+                 (unsigned long long)result.steadyAllocations, (unsigned long long)result.steadyBytes,
+                 (unsigned long long)result.arenaAllocations, result.key().c_str());
+        return text;
+    }
+
+    // ns_per_edge by key from a previous run's output (one result per line)
+    std::map<std::string, double> loadBaseline() const {
+        std::map<std::string, double> baseline;
+        if (options.baseline.empty())
+            return baseline;
+        std::ifstream in(options.baseline);
+        if (!in)
+            throw std::runtime_error("cannot read baseline " + options.baseline);
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t key = line.find("\"key\": \""), cost = line.find("\"ns_per_edge\": ");
+            if (key == std::string::npos || cost == std::string::npos)
+                continue;
+            key += 8;
+            baseline[line.substr(key, line.find('"', key) - key)] = strtod(line.c_str() + cost + 15, nullptr);
+        }
+        return baseline;
+    }
+
+    // Linux keeps the process's peak resident size in VmHWM; writing 5 to clear_refs resets it.
+    // Both report -1 where /proc is missing or not writable.
+    static void resetPeakRss() {
+        FILE* file = fopen("/proc/self/clear_refs", "w");
+        if (file) {
+            fputs("5", file);
+            fclose(file);
+        }
+    }
+
+    static long residentKb(const char* field) {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.compare(0, strlen(field), field) == 0)
+                return strtol(line.c_str() + strlen(field), nullptr, 10);
+        }
+        return -1;
+    }
+};
+
+static std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+        items.push_back(item);
+    return items;
+}
+
+// Usage: Benchmark [--families uniform,grid,rmat,complete] [--algorithms Boruvka,Kruskal,...]
+//                  [--weights int,real] [--max-edges N] [--repeat N] [--seed N] [--threads N]
+//                  [--baseline old.json [--tolerance 0.10]] [--kernels scalar|avx2|avx512]
+int main(int argc, char* argv[]) {
+    Benchmark::Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (flag == "--families" && hasValue) {
+            options.families = splitList(argv[++i]);
+        } else if (flag == "--algorithms" && hasValue) {
+            options.algorithms = splitList(argv[++i]);
+        } else if (flag == "--weights" && hasValue) {
+            options.weights = splitList(argv[++i]);
+        } else if (flag == "--max-edges" && hasValue) {
+            options.maxEdges = strtoull(argv[++i], nullptr, 10);
+        } else if (flag == "--repeat" && hasValue) {
+            options.repeat = atoi(argv[++i]);
+        } else if (flag == "--seed" && hasValue) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (flag == "--threads" && hasValue) {
+            options.numThreads = strtoul(argv[++i], nullptr, 10);
+        } else if (flag == "--baseline" && hasValue) {
+            options.baseline = argv[++i];
+        } else if (flag == "--tolerance" && hasValue) {
+            options.tolerance = strtod(argv[++i], nullptr);
+        } else if (flag == "--kernels" && hasValue) {
+            std::string level = argv[++i];
+            EdgeKernels::Level wanted = level == "avx512" ? EdgeKernels::AVX512
+                                        : level == "avx2" ? EdgeKernels::AVX2
+                                                          : EdgeKernels::Scalar;
+            EdgeKernels::level() = std::min(wanted, EdgeKernels::supported());
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--families uniform,grid,rmat,complete] [--algorithms names]"
+                      << " [--weights int,real] [--max-edges N] [--repeat N] [--seed N] [--threads N]"
+                      << " [--baseline old.json [--tolerance 0.10]] [--kernels scalar|avx2|avx512]" << std::endl;
+            return 1;
+        }
+    }
+
+    try {
+        for (const std::string& algorithm : options.algorithms)
+            MSTFactory::createSolver(algorithm);  // Fail before the sweep starts
+        Benchmark benchmark(options);
+        return benchmark.run(std::cout);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
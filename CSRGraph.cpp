@@ -0,0 +1,468 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "EdgeView.cpp"
+
+// Undirected weighted graph in Compressed Sparse Row form.
+// Adjacency is three contiguous arrays: offsets (V + 1), targets and weights (one slot per edge
+// direction, each vertex's slice sorted by target). Edits are not applied in place: they go into a
+// small delta buffer (latest operation per vertex pair wins) that is merged into fresh CSR arrays
+// once it reaches compactThreshold, or whenever a reader calls compact(). With ManualCompaction the
+// owner decides when, e.g. compacting a copy on another thread and adopting it with rebase().
+// The adjacency is the only copy of the edges (24 bytes per edge): edge-centric solvers get each
+// edge once from its u <= v slot through copyEdges(), into scratch that lives for one solve.
+// The compacted arrays are immutable and shared: copying a CSRGraph only copies the newest edits
+// (at most RecentEdits; older ones sit in a frozen map that copies share), and compaction builds
+// new arrays instead of overwriting the ones other copies still read. They may also be external
+// (non-owning), e.g. mapped straight from a graph file.
+class CSRGraph {
+public:
+    // What the bulk constructor does with repeated (u, v) records
+    enum DuplicatePolicy {
+        KeepParallelEdges,  // Keep every record as its own edge
+        LastRecordWins      // Upsert semantics, as if the records were added one by one
+    };
+
+    static constexpr size_t ManualCompaction = SIZE_MAX;  // Threshold that never compacts on its own
+    static constexpr size_t RecentEdits = 64;             // Unshared edits before they are frozen
+
+    CSRGraph(int numVertices, size_t compactThreshold = 4096)
+        : n(numVertices), liveEdges(0), threshold(compactThreshold), numPending(0) {
+        std::shared_ptr<Base> empty = std::make_shared<Base>();
+        empty->ownedOffsets.assign(numVertices + 1, 0);
+        empty->useOwned();
+        base = std::move(empty);
+    }
+
+    // Bulk build from an edge list in O(V + E log(max degree)), without going through the delta buffer
+    CSRGraph(int numVertices, const EdgeView& edges, DuplicatePolicy duplicates = KeepParallelEdges,
+             size_t compactThreshold = 4096)
+        : n(numVertices), liveEdges(0), threshold(compactThreshold), numPending(0) {
+        std::shared_ptr<Base> built = std::make_shared<Base>();
+        std::vector<size_t>& offsets = built->ownedOffsets;
+        std::vector<int>& targets = built->ownedTargets;
+        std::vector<double>& weights = built->ownedWeights;
+        offsets.assign(n + 1, 0);
+        for (size_t e = 0; e < edges.count; ++e) {
+            checkVertex(edges.sources[e]);
+            checkVertex(edges.targets[e]);
+            offsets[edges.sources[e] + 1]++;
+            if (edges.sources[e] != edges.targets[e])
+                offsets[edges.targets[e] + 1]++;
+        }
+        for (int i = 0; i < n; ++i)
+            offsets[i + 1] += offsets[i];
+
+        targets.resize(offsets[n]);
+        weights.resize(offsets[n]);
+        std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t e = 0; e < edges.count; ++e) {
+            int u = edges.sources[e], v = edges.targets[e];
+            double w = edges.weights[e];
+            targets[fill[u]] = v;
+            weights[fill[u]++] = w;
+            if (u != v) {
+                targets[fill[v]] = u;
+                weights[fill[v]++] = w;
+            }
+        }
+        sortSlices(*built, duplicates);
+        built->useOwned();
+        countEdges(*built);
+        liveEdges = built->numEdges;
+        base = std::move(built);
+    }
+
+    // Compacted arrays that live elsewhere, e.g. in a memory-mapped file
+    struct ExternalArrays {
+        const size_t* offsets;  // numVertices + 1 entries
+        const int* targets;     // offsets[numVertices] entries, each slice sorted by target
+        const double* weights;
+        size_t numEdges;        // Undirected edges: slots with u <= target
+    };
+
+    // Use the arrays in place, without copying. `owner` keeps their memory alive for as long as
+    // this graph or any copy of it still reads them; edits go to the delta buffer as usual.
+    CSRGraph(int numVertices, const ExternalArrays& arrays, std::shared_ptr<const void> owner,
+             size_t compactThreshold = 4096)
+        : n(numVertices), liveEdges(arrays.numEdges), threshold(compactThreshold), numPending(0) {
+        std::shared_ptr<Base> external = std::make_shared<Base>();
+        external->mapping = std::move(owner);
+        external->offsets = arrays.offsets;
+        external->targets = arrays.targets;
+        external->weights = arrays.weights;
+        external->numEdges = arrays.numEdges;
+        base = std::move(external);
+    }
+
+    int numVertices() const {
+        return n;
+    }
+
+    // Number of undirected edges, pending edits included
+    size_t numEdges() const {
+        return liveEdges;
+    }
+
+    bool hasPendingUpdates() const {
+        return numPending != 0;
+    }
+
+    // Vertex pairs with an edit in the delta buffer
+    size_t pendingUpdates() const {
+        return numPending;
+    }
+
+    void setCompactThreshold(size_t compactThreshold) {
+        threshold = compactThreshold;
+    }
+
+    // Insert the edge, or update its weight if (u, v) already exists
+    void addEdge(int u, int v, double w) {
+        checkVertex(u);
+        checkVertex(v);
+        if (!contains(u, v))
+            liveEdges++;
+        setPending({u, v, w, false});
+        maybeCompact();
+    }
+
+    // Remove (u, v) if present. Returns false when there was no such edge.
+    bool removeEdge(int u, int v) {
+        if (u < 0 || u >= n || v < 0 || v >= n || !contains(u, v))
+            return false;
+        liveEdges--;
+        setPending({u, v, 0.0, true});
+        maybeCompact();
+        return true;
+    }
+
+    bool contains(int u, int v) const {
+        const PendingEdit* edit = findPending(key(u, v));
+        if (edit)
+            return !edit->removed;
+        return baseSlot(u, v) != size_t(-1);
+    }
+
+    // Merge the delta buffer into new CSR arrays
+    void compact() {
+        if (numPending == 0)
+            return;
+
+        // Pending upserts in both directions, grouped by the vertex they are stored under
+        std::vector<std::pair<int, std::pair<int, double>>> inserts;
+        forEachPending([&](const PendingEdit& edit) {
+            if (edit.removed)
+                return;
+            inserts.push_back({edit.v, {edit.u, edit.weight}});
+            if (edit.u != edit.v)
+                inserts.push_back({edit.u, {edit.v, edit.weight}});
+        });
+        std::sort(inserts.begin(), inserts.end());
+
+        // Visiting "from" vertices in ascending order and writing each entry into the slice of its
+        // other endpoint produces slices that are already sorted by target.
+        std::shared_ptr<Base> merged = std::make_shared<Base>();
+        std::vector<size_t>& newOffsets = merged->ownedOffsets;
+        newOffsets.assign(n + 1, 0);
+        forEachMergedEntry(inserts, [&](int from, int to, double) {
+            (void)from;
+            newOffsets[to + 1]++;
+        });
+        for (int i = 0; i < n; ++i)
+            newOffsets[i + 1] += newOffsets[i];
+
+        merged->ownedTargets.resize(newOffsets[n]);
+        merged->ownedWeights.resize(newOffsets[n]);
+        std::vector<size_t> fill(newOffsets.begin(), newOffsets.end() - 1);
+        forEachMergedEntry(inserts, [&](int from, int to, double w) {
+            merged->ownedTargets[fill[to]] = from;
+            merged->ownedWeights[fill[to]++] = w;
+        });
+
+        merged->useOwned();
+        countEdges(*merged);
+        base = std::move(merged);
+        clearPending();
+    }
+
+    // Adopt the arrays of `compacted`, a compacted copy of `older`. This graph must have been
+    // edited only on top of `older` since: it still shares older's arrays and its delta buffer
+    // holds older's edits plus newer ones. Only the newer edits stay pending, so an expensive
+    // compact() can run on a copy without holding up writers. Returns false, changing nothing,
+    // if this graph's arrays have been replaced in the meantime.
+    bool rebase(const CSRGraph& older, const CSRGraph& compacted) {
+        if (base != older.base || compacted.hasPendingUpdates())
+            return false;
+        std::vector<PendingEdit> newer;
+        forEachPending([&](const PendingEdit& edit) {
+            const PendingEdit* old = older.findPending(key(edit.u, edit.v));
+            if (!old || old->removed != edit.removed || old->weight != edit.weight)
+                newer.push_back(edit);
+        });
+        base = compacted.base;
+        clearPending();
+        for (const PendingEdit& edit : newer)
+            setPending(edit);
+        return true;
+    }
+
+    // Adjacency accessors; they describe the compacted arrays, so call compact() first
+    const size_t* offsetData() const {
+        return base->offsets;
+    }
+
+    const int* targetData() const {
+        return base->targets;
+    }
+
+    const double* weightData() const {
+        return base->weights;
+    }
+
+    // Undirected edges in the compacted arrays
+    size_t compactedEdges() const {
+        return base->numEdges;
+    }
+
+    // Write each undirected edge of the compacted arrays once (u <= v), ordered by source then
+    // target, into arrays of compactedEdges() entries
+    template <typename Index, typename Weight>
+    void copyEdges(Index* sources, Index* targets, Weight* weights) const {
+        size_t e = 0;
+        forEachEdge([&](int u, int v, double w) {
+            sources[e] = Index(u);
+            targets[e] = Index(v);
+            weights[e++] = Weight(w);
+        });
+    }
+
+    template <typename Fn>
+    void forEachNeighbor(int u, Fn&& fn) const {
+        for (size_t i = base->offsets[u]; i < base->offsets[u + 1]; ++i)
+            fn(base->targets[i], base->weights[i]);
+    }
+
+    // Each undirected edge once, as (u, v, w) with u <= v
+    template <typename Fn>
+    void forEachEdge(Fn&& fn) const {
+        forEachEdge(*base, fn);
+    }
+
+    // Every current edge (delta buffer included) with exactly one endpoint in a vertex set, as
+    // fn(inside, outside, w). `members` lists the set and inSet(x) tests membership. Costs the
+    // members' degrees plus one pass over the delta buffer; needs no compaction.
+    template <typename InSet, typename Fn>
+    void forEachCutEdge(const std::vector<int>& members, InSet&& inSet, Fn&& fn) const {
+        for (int x : members) {
+            for (size_t i = base->offsets[x]; i < base->offsets[x + 1]; ++i) {
+                int y = base->targets[i];
+                if (!inSet(y) && !findPending(key(x, y)))
+                    fn(x, y, base->weights[i]);
+            }
+        }
+        forEachPending([&](const PendingEdit& edit) {
+            if (edit.removed)
+                return;
+            bool u = inSet(edit.u), v = inSet(edit.v);
+            if (u != v)
+                fn(u ? edit.u : edit.v, u ? edit.v : edit.u, edit.weight);
+        });
+    }
+
+    std::vector<std::pair<int, std::pair<int, double>>> toEdgeList() const {
+        std::vector<std::pair<int, std::pair<int, double>>> edges;
+        edges.reserve(base->numEdges + numPending);
+        forEachEdge([&](int u, int v, double w) {
+            if (!findPending(key(u, v)))
+                edges.push_back({u, {v, w}});
+        });
+        forEachPending([&](const PendingEdit& edit) {
+            if (!edit.removed)
+                edges.push_back({edit.u, {edit.v, edit.weight}});
+        });
+        return edges;
+    }
+
+private:
+    struct PendingEdit {
+        int u;
+        int v;
+        double weight;
+        bool removed;
+    };
+
+    typedef std::unordered_map<uint64_t, PendingEdit> EditMap;
+
+    // Compacted arrays; never modified once published. The pointers refer either to the owned
+    // vectors or to external memory kept alive by `mapping`.
+    struct Base {
+        const size_t* offsets = nullptr;
+        const int* targets = nullptr;
+        const double* weights = nullptr;
+        size_t numEdges = 0;  // Slots with u <= target
+
+        std::vector<size_t> ownedOffsets;
+        std::vector<int> ownedTargets;
+        std::vector<double> ownedWeights;
+        std::shared_ptr<const void> mapping;
+
+        void useOwned() {
+            offsets = ownedOffsets.data();
+            targets = ownedTargets.data();
+            weights = ownedWeights.data();
+        }
+    };
+
+    int n;
+    size_t liveEdges;
+    size_t threshold;
+    std::shared_ptr<const Base> base;
+
+    // The delta buffer in two levels: `recent` (at most RecentEdits entries, copied with the graph)
+    // overrides `frozen` (shared by copies, replaced rather than modified). A copy thus costs
+    // O(RecentEdits) instead of O(compactThreshold), and every RecentEdits-th edit pays for one
+    // copy of the frozen map.
+    std::shared_ptr<const EditMap> frozen;
+    EditMap recent;
+    size_t numPending;  // Distinct pairs in both levels
+
+    static uint64_t key(int u, int v) {
+        if (u > v)
+            std::swap(u, v);
+        return (uint64_t(uint32_t(u)) << 32) | uint32_t(v);
+    }
+
+    void checkVertex(int u) const {
+        if (u < 0 || u >= n)
+            throw std::out_of_range("Vertex out of range.");
+    }
+
+    void maybeCompact() {
+        if (numPending >= threshold)
+            compact();
+    }
+
+    const PendingEdit* findPending(uint64_t k) const {
+        auto it = recent.find(k);
+        if (it != recent.end())
+            return &it->second;
+        if (frozen) {
+            auto old = frozen->find(k);
+            if (old != frozen->end())
+                return &old->second;
+        }
+        return nullptr;
+    }
+
+    void setPending(const PendingEdit& edit) {
+        uint64_t k = key(edit.u, edit.v);
+        if (!findPending(k))
+            numPending++;
+        recent[k] = edit;
+        if (recent.size() < RecentEdits)
+            return;
+        std::shared_ptr<EditMap> merged = frozen ? std::make_shared<EditMap>(*frozen) : std::make_shared<EditMap>();
+        for (const auto& entry : recent)
+            (*merged)[entry.first] = entry.second;
+        frozen = std::move(merged);
+        recent.clear();
+    }
+
+    void clearPending() {
+        frozen.reset();
+        recent.clear();
+        numPending = 0;
+    }
+
+    // The latest edit of every pending pair
+    template <typename Fn>
+    void forEachPending(Fn&& fn) const {
+        for (const auto& entry : recent)
+            fn(entry.second);
+        if (!frozen)
+            return;
+        for (const auto& entry : *frozen) {
+            if (recent.find(entry.first) == recent.end())
+                fn(entry.second);
+        }
+    }
+
+    // Slot of v in u's compacted slice, or size_t(-1)
+    size_t baseSlot(int u, int v) const {
+        const int* first = base->targets + base->offsets[u];
+        const int* last = base->targets + base->offsets[u + 1];
+        const int* it = std::lower_bound(first, last, v);
+        return (it != last && *it == v) ? size_t(it - base->targets) : size_t(-1);
+    }
+
+    // Every directed entry of the merged graph, with "from" ascending: surviving base entries of
+    // each vertex followed by its pending inserts.
+    template <typename Fn>
+    void forEachMergedEntry(const std::vector<std::pair<int, std::pair<int, double>>>& inserts, Fn&& fn) const {
+        const size_t* offsets = base->offsets;
+        const int* targets = base->targets;
+        size_t next = 0;
+        for (int from = 0; from < n; ++from) {
+            for (size_t i = offsets[from]; i < offsets[from + 1]; ++i) {
+                if (!findPending(key(from, targets[i])))
+                    fn(from, targets[i], base->weights[i]);
+            }
+            for (; next < inserts.size() && inserts[next].first == from; ++next)
+                fn(from, inserts[next].second.first, inserts[next].second.second);
+        }
+    }
+
+    template <typename Fn>
+    void forEachEdge(const Base& arrays, Fn&& fn) const {
+        for (int u = 0; u < n; ++u) {
+            for (size_t i = arrays.offsets[u]; i < arrays.offsets[u + 1]; ++i) {
+                if (u <= arrays.targets[i])
+                    fn(u, arrays.targets[i], arrays.weights[i]);
+            }
+        }
+    }
+
+    void countEdges(Base& arrays) const {
+        arrays.numEdges = 0;
+        forEachEdge(arrays, [&](int, int, double) { arrays.numEdges++; });
+    }
+
+    // Sort every slice by target. With LastRecordWins, repeated targets in a slice collapse to the
+    // entry filled last (fill order within a slice follows input order) and the arrays shrink.
+    void sortSlices(Base& arrays, DuplicatePolicy duplicates) const {
+        std::vector<size_t>& offsets = arrays.ownedOffsets;
+        std::vector<int>& targets = arrays.ownedTargets;
+        std::vector<double>& weights = arrays.ownedWeights;
+        std::vector<std::pair<int, double>> slice;
+        size_t write = 0;
+        for (int u = 0; u < n; ++u) {
+            slice.clear();
+            for (size_t i = offsets[u]; i < offsets[u + 1]; ++i)
+                slice.push_back({targets[i], weights[i]});
+
+            offsets[u] = write;
+            if (duplicates == KeepParallelEdges) {
+                std::sort(slice.begin(), slice.end());
+            } else {
+                std::stable_sort(slice.begin(), slice.end(), [](const std::pair<int, double>& a, const std::pair<int, double>& b) {
+                    return a.first < b.first;
+                });
+            }
+            for (size_t i = 0; i < slice.size(); ++i) {
+                if (duplicates == LastRecordWins && i + 1 < slice.size() && slice[i + 1].first == slice[i].first)
+                    continue;
+                targets[write] = slice[i].first;
+                weights[write++] = slice[i].second;
+            }
+        }
+        offsets[n] = write;
+        targets.resize(write);
+        weights.resize(write);
+    }
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <stdexcept>
+
+// Thrown at a cancellation point once the running operation has been cancelled
+class OperationCancelled : public std::runtime_error {
+public:
+    OperationCancelled() : std::runtime_error("cancelled") {}
+};
+
+// Cooperative cancellation flag of one operation. cancel() may be called from any thread; the
+// operation notices at its next cancellation point, so a solve stops between two rounds rather
+// than at an arbitrary instruction and never leaves shared state half-updated.
+class CancellationToken {
+public:
+    CancellationToken() : requested(false) {}
+
+    void cancel() {
+        requested.store(true, std::memory_order_relaxed);
+    }
+
+    bool cancelled() const {
+        return requested.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<bool> requested;
+};
+
+// The token cancellationPoint() checks on this thread, or nullptr outside any cancellable operation
+inline const CancellationToken*& currentCancellation() {
+    thread_local const CancellationToken* token = nullptr;
+    return token;
+}
+
+// Makes a token the current one for the lifetime of the scope
+class CancellationScope {
+public:
+    explicit CancellationScope(const CancellationToken& token) : previous(currentCancellation()) {
+        currentCancellation() = &token;
+    }
+
+    ~CancellationScope() {
+        currentCancellation() = previous;
+    }
+
+    CancellationScope(const CancellationScope&) = delete;
+    CancellationScope& operator=(const CancellationScope&) = delete;
+
+private:
+    const CancellationToken* previous;
+};
+
+// Called by long computations between rounds: throws OperationCancelled if the operation running
+// on this thread has been cancelled. Costs one relaxed load when it has not.
+inline void cancellationPoint() {
+    const CancellationToken* token = currentCancellation();
+    if (token && token->cancelled())
+        throw OperationCancelled();
+}
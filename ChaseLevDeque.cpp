@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Chase-Lev work-stealing deque of pointers (Le, Pop, Cohen, Zappa Nardelli, PPoPP 2013).
+// The owning thread pushes and pops at the bottom; any other thread may steal from the top.
+// nullptr means "empty" (or a lost race for the last element). The ring grows by doubling; old
+// rings are retired, not freed, until the deque is destroyed, since a thief may still read them.
+template <typename T>
+class ChaseLevDeque {
+public:
+    ChaseLevDeque(int64_t initialCapacity = 256) : top(0), bottom(0) {
+        retired.emplace_back(new Ring(initialCapacity));
+        ring.store(retired.back().get(), std::memory_order_relaxed);
+    }
+
+    // Owner only
+    void push(T* item) {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        Ring* r = ring.load(std::memory_order_relaxed);
+        if (b - t > r->capacity - 1) {
+            r = grow(r, t, b);
+            ring.store(r, std::memory_order_release);
+        }
+        r->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only
+    T* pop() {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Ring* r = ring.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T* item = r->get(b);
+        if (t == b) {
+            // Last element: race the thieves for it
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                item = nullptr;
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Any thread
+    T* steal() {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return nullptr;
+
+        Ring* r = ring.load(std::memory_order_acquire);
+        T* item = r->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return item;
+    }
+
+    // Approximate; only used as a hint by idle workers
+    bool empty() const {
+        return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Ring {
+        int64_t capacity;
+        std::unique_ptr<std::atomic<T*>[]> slots;
+
+        Ring(int64_t capacity) : capacity(capacity), slots(new std::atomic<T*>[capacity]) {}
+
+        T* get(int64_t i) const {
+            return slots[i & (capacity - 1)].load(std::memory_order_acquire);
+        }
+
+        void put(int64_t i, T* item) {
+            slots[i & (capacity - 1)].store(item, std::memory_order_release);
+        }
+    };
+
+    alignas(64) std::atomic<int64_t> top;
+    alignas(64) std::atomic<int64_t> bottom;
+    alignas(64) std::atomic<Ring*> ring;
+    std::vector<std::unique_ptr<Ring>> retired;  // Owner only
+
+    Ring* grow(Ring* old, int64_t t, int64_t b) {
+        retired.emplace_back(new Ring(old->capacity * 2));
+        Ring* bigger = retired.back().get();
+        for (int64_t i = t; i < b; ++i)
+            bigger->put(i, old->get(i));
+        return bigger;
+    }
+};
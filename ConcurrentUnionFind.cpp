@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+// Lock-free disjoint-set forest.
+// Each node keeps its rank and parent packed in one 64-bit word, so a root can only be hooked
+// under another root with a single CAS that also validates its rank. Parents are always strictly
+// greater in (rank, id) order, which keeps the forest acyclic under concurrent unions.
+// find() uses path halving; several threads may call find() and unite() at the same time.
+class ConcurrentUnionFind {
+public:
+    // The nodes live in `memory`, e.g. a solver workspace's arena
+    ConcurrentUnionFind(int numVertices, std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : numVertices(numVertices), nodes(size_t(numVertices > 0 ? numVertices : 1), memory) {
+        for (int i = 0; i < numVertices; ++i)
+            nodes[i].store(pack(0, i), std::memory_order_relaxed);
+    }
+
+    int size() const {
+        return numVertices;
+    }
+
+    // Representative of x's set
+    int find(int x) {
+        while (true) {
+            uint64_t wx = nodes[x].load(std::memory_order_acquire);
+            int p = parentOf(wx);
+            if (p == x)
+                return x;
+
+            uint64_t wp = nodes[p].load(std::memory_order_acquire);
+            int gp = parentOf(wp);
+            if (gp != p) {
+                // Path halving: point x at its grandparent, keeping x's (frozen) rank
+                nodes[x].compare_exchange_weak(wx, pack(rankOf(wx), gp), std::memory_order_acq_rel);
+            }
+            x = gp;
+        }
+    }
+
+    bool connected(int x, int y) {
+        while (true) {
+            x = find(x);
+            y = find(y);
+            if (x == y)
+                return true;
+            // x is still a root, so the two sets really were distinct at this point
+            if (parentOf(nodes[x].load(std::memory_order_acquire)) == x)
+                return false;
+        }
+    }
+
+    // Merge the sets of x and y. Returns true only for the call that actually linked them.
+    bool unite(int x, int y) {
+        while (true) {
+            x = find(x);
+            y = find(y);
+            if (x == y)
+                return false;
+
+            uint64_t wx = nodes[x].load(std::memory_order_acquire);
+            uint64_t wy = nodes[y].load(std::memory_order_acquire);
+            if (parentOf(wx) != x || parentOf(wy) != y)
+                continue;  // Someone hooked one of the roots meanwhile
+
+            uint32_t rx = rankOf(wx), ry = rankOf(wy);
+            if (rx > ry || (rx == ry && x > y)) {
+                std::swap(x, y);
+                std::swap(wx, wy);
+                std::swap(rx, ry);
+            }
+
+            // Hook the smaller root x under y
+            if (!nodes[x].compare_exchange_strong(wx, pack(rx, y), std::memory_order_acq_rel))
+                continue;
+
+            if (rx == ry) {
+                // Best effort: fails harmlessly if y stopped being a root or was bumped already
+                uint64_t expected = pack(ry, y);
+                nodes[y].compare_exchange_strong(expected, pack(ry + 1, y), std::memory_order_acq_rel);
+            }
+            return true;
+        }
+    }
+
+private:
+    int numVertices;
+    std::pmr::vector<std::atomic<uint64_t>> nodes;
+
+    static uint64_t pack(uint32_t rank, int parent) {
+        return (uint64_t(rank) << 32) | uint32_t(parent);
+    }
+
+    static int parentOf(uint64_t word) {
+        return int(uint32_t(word));
+    }
+
+    static uint32_t rankOf(uint64_t word) {
+        return uint32_t(word >> 32);
+    }
+};
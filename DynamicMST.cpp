@@ -0,0 +1,209 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "CSRGraph.cpp"
+#include "EdgeIndex.cpp"
+#include "IMSTSolver.cpp"
+#include "LinkCutTree.cpp"
+
+// Minimum spanning forest maintained under edge insertions, deletions and weight changes.
+// Tree edges are nodes of a link-cut tree (vertices carry -inf), so the heaviest edge on the tree
+// path between two vertices is a single pathMax query:
+//  - insert: if the endpoints are already connected, the new edge replaces the path maximum when
+//    it is lighter, otherwise it stays a non-tree edge;
+//  - delete of a tree edge: the tree is cut and the lightest graph edge crossing the cut is linked
+//    in. Both halves are searched at once over the tree edges, so only the smaller half S is
+//    walked in full, and the edges at S are read from the graph itself.
+// Only the forest is stored: per vertex a link-cut node and its tree neighbours, per tree edge a
+// node and an index entry. Non-tree edges are not duplicated, so the memory is O(V) whatever the
+// number of edges. The price is on the delete (or weight increase) of a tree edge, which costs
+// O(|S| + edges at S + pending graph edits); insertions and other deletions are O(log n)
+// amortized. The current forest is kept in a dense array, so reading it costs O(forest size).
+class DynamicMST {
+public:
+    DynamicMST(int numVertices)
+        : numVertices(numVertices), lct(numVertices), treeNeighbors(numVertices), mark(numVertices, 0), epoch(0),
+          totalWeight(0.0) {}
+
+    // Seed from a spanning forest already computed for the graph
+    void build(const MSTResult& forest) {
+        for (const WeightedEdge& edge : forest.edges) {
+            int u = std::min(edge.u, edge.v), v = std::max(edge.u, edge.v);
+            if (u != v && treeIndex.find(u, v) == EdgeIndex::NotFound && !lct.connected(u, v))
+                makeTreeEdge(u, v, edge.weight);
+        }
+    }
+
+    // Insert (u, v), or change its weight if it already exists. `graph` already has the edit.
+    void insertEdge(int u, int v, double weight, const CSRGraph& graph) {
+        if (u > v)
+            std::swap(u, v);
+        if (u == v)
+            return;
+
+        size_t position = treeIndex.find(u, v);
+        if (position == EdgeIndex::NotFound) {
+            place(u, v, weight);  // New, or a non-tree edge with a new weight
+        } else if (weight <= treeEdges[position].weight) {
+            // A tree edge getting lighter stays in the forest
+            totalWeight += weight - treeEdges[position].weight;
+            treeEdges[position].weight = weight;
+            lct.setValue(treeNodes[position], weight);
+        } else {
+            // A tree edge getting heavier may be replaced by a lighter edge across the cut,
+            // itself included at its new weight
+            dropTreeEdge(position);
+            reconnect(u, v, graph);
+        }
+    }
+
+    // Remove (u, v); `graph` no longer has it
+    void removeEdge(int u, int v, const CSRGraph& graph) {
+        if (u > v)
+            std::swap(u, v);
+        size_t position = treeIndex.find(u, v);
+        if (position == EdgeIndex::NotFound)
+            return;  // Non-tree (or unknown) edges do not affect the forest
+        dropTreeEdge(position);
+        reconnect(u, v, graph);
+    }
+
+    // Copy the current forest into the caller's buffer
+    void collect(MSTResult& result) const {
+        result.clear();
+        result.edges.assign(treeEdges.begin(), treeEdges.end());
+        result.totalWeight = totalWeight;
+    }
+
+    size_t size() const {
+        return treeEdges.size();
+    }
+
+private:
+    int numVertices;
+    LinkCutTree lct;
+    EdgeIndex treeIndex;                          // (u, v), u < v -> index in treeEdges
+    std::vector<WeightedEdge> treeEdges;          // u < v
+    std::vector<int> treeNodes;                   // Link-cut node of each tree edge
+    std::vector<int> nodePosition;                // Indexed by link-cut node id - numVertices
+    std::vector<std::vector<int>> treeNeighbors;  // Forest adjacency, for the cut search
+    std::vector<uint32_t> mark;                   // Cut search: side stamp per vertex
+    uint32_t epoch;
+    std::vector<int> sides[2];                    // Cut search: vertices reached from each end
+    double totalWeight;
+
+    // Decide whether a new (or re-weighted) non-tree edge belongs in the forest
+    void place(int u, int v, double weight) {
+        if (!lct.connected(u, v)) {
+            makeTreeEdge(u, v, weight);
+            return;
+        }
+
+        int heaviest = lct.pathMax(u, v);
+        if (weight < lct.value(heaviest)) {
+            dropTreeEdge(size_t(positionOf(heaviest)));  // Stays in the graph as a non-tree edge
+            makeTreeEdge(u, v, weight);
+        }
+    }
+
+    void makeTreeEdge(int u, int v, double weight) {
+        int node = lct.addNode(weight);
+        lct.link(u, node);
+        lct.link(node, v);
+
+        int position = int(treeEdges.size());
+        treeEdges.push_back({u, v, weight});
+        treeNodes.push_back(node);
+        treeIndex.set(u, v, size_t(position));
+        positionOf(node) = position;
+        treeNeighbors[u].push_back(v);
+        treeNeighbors[v].push_back(u);
+        totalWeight += weight;
+    }
+
+    void dropTreeEdge(size_t position) {
+        WeightedEdge edge = treeEdges[position];
+        int node = treeNodes[position];
+        lct.cut(edge.u, node);
+        lct.cut(node, edge.v);
+        lct.releaseNode(node);
+        treeIndex.erase(edge.u, edge.v);
+        unlinkNeighbor(edge.u, edge.v);
+        unlinkNeighbor(edge.v, edge.u);
+
+        // Swap-remove from the dense forest arrays
+        size_t last = treeEdges.size() - 1;
+        if (position != last) {
+            treeEdges[position] = treeEdges[last];
+            treeNodes[position] = treeNodes[last];
+            treeIndex.set(treeEdges[position].u, treeEdges[position].v, position);
+            positionOf(treeNodes[position]) = int(position);
+        }
+        treeEdges.pop_back();
+        treeNodes.pop_back();
+        totalWeight -= edge.weight;
+    }
+
+    void unlinkNeighbor(int u, int v) {
+        std::vector<int>& neighbors = treeNeighbors[u];
+        auto it = std::find(neighbors.begin(), neighbors.end(), v);
+        *it = neighbors.back();
+        neighbors.pop_back();
+    }
+
+    // After the tree edge (u, v) was cut: link the lightest graph edge between the two halves, if any
+    void reconnect(int u, int v, const CSRGraph& graph) {
+        int side = smallerSide(u, v);
+        uint32_t stamp = epoch + uint32_t(side);
+        int bestInside = -1, bestOutside = -1;
+        double bestWeight = std::numeric_limits<double>::infinity();
+        graph.forEachCutEdge(sides[side], [&](int x) { return mark[x] == stamp; }, [&](int inside, int outside, double w) {
+            if (bestInside == -1 || w < bestWeight) {
+                bestInside = inside;
+                bestOutside = outside;
+                bestWeight = w;
+            }
+        });
+        if (bestInside != -1)
+            makeTreeEdge(std::min(bestInside, bestOutside), std::max(bestInside, bestOutside), bestWeight);
+    }
+
+    // Searches the trees of a and b (now disconnected) in lockstep until one is exhausted, so the
+    // cost is proportional to the smaller one. Returns which of sides[0] (a) and sides[1] (b) it
+    // is; its vertices carry mark == epoch + side.
+    int smallerSide(int a, int b) {
+        if (epoch >= UINT32_MAX - 2) {
+            std::fill(mark.begin(), mark.end(), 0);
+            epoch = 0;
+        }
+        epoch += 2;
+        size_t head[2] = {0, 0};
+        for (int side = 0; side < 2; ++side) {
+            sides[side].clear();
+            sides[side].push_back(side == 0 ? a : b);
+            mark[side == 0 ? a : b] = epoch + uint32_t(side);
+        }
+        for (int side = 0;; side ^= 1) {
+            std::vector<int>& reached = sides[side];
+            if (head[side] == reached.size())
+                return side;
+            int x = reached[head[side]++];
+            for (int y : treeNeighbors[x]) {
+                if (mark[y] != epoch + uint32_t(side)) {
+                    mark[y] = epoch + uint32_t(side);
+                    reached.push_back(y);
+                }
+            }
+        }
+    }
+
+    // treeEdges index of the edge a link-cut node stands for
+    int& positionOf(int node) {
+        size_t slot = size_t(node - numVertices);
+        if (slot >= nodePosition.size())
+            nodePosition.resize(slot + 1, -1);
+        return nodePosition[slot];
+    }
+};
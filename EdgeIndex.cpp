@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Open-addressing hash map from a directed vertex pair (u, v) to a position, e.g. where v sits in
+// u's adjacency array. Linear probing over a power-of-two table of 16-byte slots, kept at most half
+// full; erase shifts the following entries back instead of leaving tombstones, so lookups never
+// slow down with churn. Vertex ids must be non-negative.
+class EdgeIndex {
+public:
+    static constexpr size_t NotFound = SIZE_MAX;
+
+    EdgeIndex() : slots(16), count(0) {}
+
+    size_t size() const {
+        return count;
+    }
+
+    // Position stored for (u, v), or NotFound
+    size_t find(int u, int v) const {
+        uint64_t k = key(u, v);
+        for (size_t i = home(k);; i = next(i)) {
+            if (slots[i].key == k)
+                return slots[i].position;
+            if (slots[i].key == Empty)
+                return NotFound;
+        }
+    }
+
+    // Inserts (u, v) or overwrites its position
+    void set(int u, int v, size_t position) {
+        if (2 * (count + 1) > slots.size())
+            grow();
+        uint64_t k = key(u, v);
+        size_t i = home(k);
+        while (slots[i].key != Empty && slots[i].key != k)
+            i = next(i);
+        if (slots[i].key == Empty)
+            count++;
+        slots[i] = Slot{k, position};
+    }
+
+    bool erase(int u, int v) {
+        uint64_t k = key(u, v);
+        size_t hole = home(k);
+        while (slots[hole].key != k) {
+            if (slots[hole].key == Empty)
+                return false;
+            hole = next(hole);
+        }
+
+        // Move back every entry of the probe run that the hole would otherwise cut off from its home
+        for (size_t i = next(hole); slots[i].key != Empty; i = next(i)) {
+            size_t h = home(slots[i].key);
+            bool reachable = hole < i ? (h > hole && h <= i) : (h > hole || h <= i);
+            if (!reachable) {
+                slots[hole] = slots[i];
+                hole = i;
+            }
+        }
+        slots[hole].key = Empty;
+        count--;
+        return true;
+    }
+
+private:
+    static constexpr uint64_t Empty = UINT64_MAX;  // No valid pair has both ids all ones
+
+    struct Slot {
+        uint64_t key = Empty;
+        size_t position = 0;
+    };
+
+    std::vector<Slot> slots;
+    size_t count;
+
+    static uint64_t key(int u, int v) {
+        return (uint64_t(uint32_t(u)) << 32) | uint32_t(v);
+    }
+
+    // Fibonacci hashing: the high bits of the product depend on every bit of the key
+    size_t home(uint64_t k) const {
+        return size_t((k * 0x9e3779b97f4a7c15ULL) >> (64 - __builtin_ctzll(slots.size())));
+    }
+
+    size_t next(size_t i) const {
+        return (i + 1) & (slots.size() - 1);
+    }
+
+    void grow() {
+        std::vector<Slot> old(2 * slots.size());
+        old.swap(slots);
+        for (const Slot& slot : old) {
+            if (slot.key == Empty)
+                continue;
+            size_t i = home(slot.key);
+            while (slots[i].key != Empty)
+                i = next(i);
+            slots[i] = slot;
+        }
+    }
+};
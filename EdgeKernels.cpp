@@ -0,0 +1,231 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define EDGE_KERNELS_X86 1
+#endif
+
+// Kernels over structure-of-arrays edge storage (separate u, v, w and id columns) with 32-bit
+// vertex ids and 32- or 64-bit weights. Each has a scalar version and, on x86, AVX2 and AVX-512
+// versions compiled through target attributes, so the binary needs no special flags: the widest
+// level the CPU supports is picked at runtime.
+class EdgeKernels {
+public:
+    enum Level { Scalar, AVX2, AVX512 };
+
+    // Widest level this CPU can run
+    static Level supported() {
+#ifdef EDGE_KERNELS_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+            return AVX512;
+        if (__builtin_cpu_supports("avx2"))
+            return AVX2;
+#endif
+        return Scalar;
+    }
+
+    // Level in use. Benchmarks and tests may lower it, but only while no solve is running.
+    static Level& level() {
+        static Level current = supported();
+        return current;
+    }
+
+    static const char* name(Level level) {
+        return level == AVX512 ? "avx512" : level == AVX2 ? "avx2" : "scalar";
+    }
+
+    // lu[i] = label[u[i]] and lv[i] = label[v[i]] for i in [0, count)
+    template <typename Index>
+    static void endpointLabels(const int* label, const Index* u, const Index* v, int* lu, int* lv, size_t count) {
+        static_assert(sizeof(Index) == 4, "vector gathers take 32-bit vertex ids");
+        size_t i = 0;
+#ifdef EDGE_KERNELS_X86
+        const int* u32 = reinterpret_cast<const int*>(u);
+        const int* v32 = reinterpret_cast<const int*>(v);
+        if (level() == AVX512)
+            i = endpointLabels512(label, u32, v32, lu, lv, count);
+        else if (level() == AVX2)
+            i = endpointLabels256(label, u32, v32, lu, lv, count);
+#endif
+        for (; i < count; ++i) {
+            lu[i] = label[u[i]];
+            lv[i] = label[v[i]];
+        }
+    }
+
+    // Keep the edges whose endpoints carry different labels, packed in place at the front of
+    // [0, count) in their original order. Returns how many were kept. Weights may be 4 or 8 bytes.
+    template <typename Index, typename Weight>
+    static size_t keepCrossing(const int* label, Index* u, Index* v, Weight* w, int* id, size_t count) {
+        static_assert(sizeof(Index) == 4, "vector gathers take 32-bit vertex ids");
+        static_assert(sizeof(Weight) == 4 || sizeof(Weight) == 8, "weights are moved as 32- or 64-bit lanes");
+        size_t i = 0, kept = 0;
+#ifdef EDGE_KERNELS_X86
+        int* u32 = reinterpret_cast<int*>(u);
+        int* v32 = reinterpret_cast<int*>(v);
+        if (level() == AVX512)
+            kept = keepCrossing512<sizeof(Weight)>(label, u32, v32, w, id, count, i);
+        else if (level() == AVX2)
+            kept = keepCrossing256<sizeof(Weight)>(label, u32, v32, w, id, count, i);
+#endif
+        for (; i < count; ++i) {
+            // Branch-free: always write, advance only for a crossing edge
+            u[kept] = u[i];
+            v[kept] = v[i];
+            w[kept] = w[i];
+            id[kept] = id[i];
+            kept += label[u[i]] != label[v[i]];
+        }
+        return kept;
+    }
+
+private:
+#ifdef EDGE_KERNELS_X86
+    __attribute__((target("avx2")))
+    static size_t endpointLabels256(const int* label, const int* u, const int* v, int* lu, int* lv, size_t count) {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i iu = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(u + i));
+            __m256i iv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(lu + i), _mm256_i32gather_epi32(label, iu, 4));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(lv + i), _mm256_i32gather_epi32(label, iv, 4));
+        }
+        return i;
+    }
+
+    // Masked form with an all-ones mask: same instruction, but GCC's unmasked wrapper trips
+    // -Wmaybe-uninitialized on its placeholder source operand
+    __attribute__((target("avx512f")))
+    static __m512i gather512(const int* base, __m512i indexes) {
+        return _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), __mmask16(0xFFFF), indexes, base, 4);
+    }
+
+    __attribute__((target("avx512f")))
+    static size_t endpointLabels512(const int* label, const int* u, const int* v, int* lu, int* lv, size_t count) {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m512i iu = _mm512_loadu_si512(u + i);
+            __m512i iv = _mm512_loadu_si512(v + i);
+            _mm512_storeu_si512(lu + i, gather512(label, iu));
+            _mm512_storeu_si512(lv + i, gather512(label, iv));
+        }
+        return i;
+    }
+
+    // Lane permutations that move the selected lanes of an 8-lane mask to the front, as 32-bit
+    // indexes; for the double column each 64-bit lane is handled as a pair of 32-bit lanes
+    struct CompressTables {
+        int32_t ints[256][8];
+        int32_t doubles[16][8];
+
+        CompressTables() {
+            for (int mask = 0; mask < 256; ++mask) {
+                int k = 0;
+                for (int lane = 0; lane < 8; ++lane) {
+                    if (mask & (1 << lane))
+                        ints[mask][k++] = lane;
+                }
+                for (; k < 8; ++k)
+                    ints[mask][k] = 0;
+            }
+            for (int mask = 0; mask < 16; ++mask) {
+                int k = 0;
+                for (int lane = 0; lane < 4; ++lane) {
+                    if (mask & (1 << lane)) {
+                        doubles[mask][k++] = 2 * lane;
+                        doubles[mask][k++] = 2 * lane + 1;
+                    }
+                }
+                for (; k < 8; ++k)
+                    doubles[mask][k] = 0;
+            }
+        }
+    };
+
+    static const CompressTables& compressTables() {
+        static const CompressTables tables;
+        return tables;
+    }
+
+    // Each block of edges is loaded in full before anything is stored, and stores land at
+    // kept <= i, so the in-place compaction never overwrites an edge it has not read yet.
+    // The weight column is moved as raw 32- or 64-bit lanes.
+    template <size_t WeightBytes>
+    __attribute__((target("avx2")))
+    static size_t keepCrossing256(const int* label, int* u, int* v, void* w, int* id, size_t count, size_t& i) {
+        const CompressTables& tables = compressTables();
+        size_t kept = 0;
+        for (i = 0; i + 8 <= count; i += 8) {
+            __m256i iu = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(u + i));
+            __m256i iv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i));
+            __m256i ids = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(id + i));
+            __m256i wLow = _mm256_loadu_si256(lanes256(w, WeightBytes, i));
+            __m256i wHigh = WeightBytes == 8 ? _mm256_loadu_si256(lanes256(w, WeightBytes, i + 4)) : wLow;
+
+            __m256i same = _mm256_cmpeq_epi32(_mm256_i32gather_epi32(label, iu, 4),
+                                              _mm256_i32gather_epi32(label, iv, 4));
+            int mask = ~_mm256_movemask_ps(_mm256_castsi256_ps(same)) & 0xFF;
+            if (mask == 0)
+                continue;
+
+            __m256i order = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tables.ints[mask]));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(u + kept), _mm256_permutevar8x32_epi32(iu, order));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(v + kept), _mm256_permutevar8x32_epi32(iv, order));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(id + kept), _mm256_permutevar8x32_epi32(ids, order));
+
+            if (WeightBytes == 4) {
+                _mm256_storeu_si256(lanes256(w, WeightBytes, kept), _mm256_permutevar8x32_epi32(wLow, order));
+            } else {
+                int lowMask = mask & 0xF, highMask = mask >> 4;
+                __m256i lowOrder = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tables.doubles[lowMask]));
+                __m256i highOrder = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tables.doubles[highMask]));
+                size_t lowCount = size_t(__builtin_popcount(unsigned(lowMask)));
+                _mm256_storeu_si256(lanes256(w, WeightBytes, kept), _mm256_permutevar8x32_epi32(wLow, lowOrder));
+                _mm256_storeu_si256(lanes256(w, WeightBytes, kept + lowCount),
+                                    _mm256_permutevar8x32_epi32(wHigh, highOrder));
+            }
+            kept += size_t(__builtin_popcount(unsigned(mask)));
+        }
+        return kept;
+    }
+
+    static __m256i* lanes256(void* base, size_t elementBytes, size_t index) {
+        return reinterpret_cast<__m256i*>(static_cast<char*>(base) + index * elementBytes);
+    }
+
+    template <size_t WeightBytes>
+    __attribute__((target("avx512f")))
+    static size_t keepCrossing512(const int* label, int* u, int* v, void* w, int* id, size_t count, size_t& i) {
+        char* weights = static_cast<char*>(w);
+        size_t kept = 0;
+        for (i = 0; i + 16 <= count; i += 16) {
+            __m512i iu = _mm512_loadu_si512(u + i);
+            __m512i iv = _mm512_loadu_si512(v + i);
+            __m512i ids = _mm512_loadu_si512(id + i);
+            __m512i wLow = _mm512_loadu_si512(weights + i * WeightBytes);
+            __m512i wHigh = WeightBytes == 8 ? _mm512_loadu_si512(weights + (i + 8) * WeightBytes) : wLow;
+
+            __mmask16 crossing = _mm512_cmpneq_epi32_mask(gather512(label, iu),
+                                                          gather512(label, iv));
+            if (crossing == 0)
+                continue;
+
+            _mm512_mask_compressstoreu_epi32(u + kept, crossing, iu);
+            _mm512_mask_compressstoreu_epi32(v + kept, crossing, iv);
+            _mm512_mask_compressstoreu_epi32(id + kept, crossing, ids);
+            if (WeightBytes == 4) {
+                _mm512_mask_compressstoreu_epi32(weights + kept * WeightBytes, crossing, wLow);
+            } else {
+                __mmask8 lowMask = __mmask8(crossing & 0xFF), highMask = __mmask8(crossing >> 8);
+                size_t lowCount = size_t(__builtin_popcount(unsigned(lowMask)));
+                _mm512_mask_compressstoreu_epi64(weights + kept * WeightBytes, lowMask, wLow);
+                _mm512_mask_compressstoreu_epi64(weights + (kept + lowCount) * WeightBytes, highMask, wHigh);
+            }
+            kept += size_t(__builtin_popcount(unsigned(crossing)));
+        }
+        return kept;
+    }
+#endif
+};
@@ -0,0 +1,272 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+#include "EdgeView.cpp"
+#include "PayloadReader.cpp"
+
+// Streaming parser for the m edge records that follow "Newgraph n,m" on a connection.
+//  - Text: one "u,v,w" record per line (blanks may separate the fields as well).
+//  - Binary: packed u32 source, u32 target and an f32 or f64 weight, in host byte order.
+// Records are decoded in place from whatever buffers the connection delivers, whatever their size;
+// only a record split across two buffers is copied, into a fixed carry area. The output arrays are
+// reserved from m up front, so parsing itself does not allocate.
+class EdgeRecordParser : public PayloadReader {
+public:
+    enum Format { Text, Binary32, Binary64 };
+
+    EdgeRecordParser(Format format, uint64_t count)
+        : format(format), expected(count), seen(0), carrySize(0), carryOverflow(false), truncated(false) {
+        try {
+            sources.reserve(count);
+            targets.reserve(count);
+            weights.reserve(count);
+        } catch (const std::exception&) {
+            // Keep consuming so the connection stays in sync; the load is rejected at the end
+            fail("not enough memory for " + std::to_string(count) + " edges");
+        }
+    }
+
+    size_t consume(const char* data, size_t size) override {
+        return format == Text ? consumeText(data, size) : consumeBinary(data, size);
+    }
+
+    bool done() const override {
+        return seen == expected || truncated;
+    }
+
+    void endOfInput() override {
+        // A final text record without a trailing newline still counts
+        if (format == Text && !done() && (carrySize > 0 || carryOverflow))
+            parseCarry();
+        if (seen < expected) {
+            fail("expected " + std::to_string(expected) + " edge records, got " + std::to_string(seen));
+            truncated = true;
+        }
+    }
+
+    bool failed() const {
+        return !message.empty();
+    }
+
+    // First problem found, e.g. "record 7: malformed edge record"
+    const std::string& error() const {
+        return message;
+    }
+
+    EdgeView edges() const {
+        return EdgeView{sources.data(), targets.data(), weights.data(), sources.size()};
+    }
+
+private:
+    static const size_t MaxTextRecord = 128;
+
+    Format format;
+    uint64_t expected;
+    uint64_t seen;  // Records consumed so far, malformed ones included
+    char carry[MaxTextRecord];
+    size_t carrySize;
+    bool carryOverflow;
+    bool truncated;
+    std::string message;
+    std::vector<int> sources;
+    std::vector<int> targets;
+    std::vector<double> weights;
+
+    void fail(const std::string& what) {
+        if (message.empty())
+            message = what;
+    }
+
+    void store(int u, int v, double w) {
+        seen++;
+        if (failed())
+            return;  // The load is rejected anyway
+        sources.push_back(u);
+        targets.push_back(v);
+        weights.push_back(w);
+    }
+
+    void reject(const char* what) {
+        seen++;
+        fail("record " + std::to_string(seen) + ": " + what);
+    }
+
+    size_t consumeText(const char* data, size_t size) {
+        const char* p = data;
+        const char* end = data + size;
+        while (p < end && seen < expected) {
+            const char* newline = static_cast<const char*>(memchr(p, '\n', size_t(end - p)));
+            if (!newline) {
+                appendCarry(p, end);  // The record continues in the next buffer
+                return size;
+            }
+            if (carrySize > 0 || carryOverflow) {
+                appendCarry(p, newline);
+                parseCarry();
+            } else {
+                parseLine(p, newline);
+            }
+            p = newline + 1;
+        }
+        return size_t(p - data);
+    }
+
+    void appendCarry(const char* begin, const char* end) {
+        size_t length = size_t(end - begin);
+        if (carrySize + length > MaxTextRecord) {
+            carryOverflow = true;
+            length = MaxTextRecord - carrySize;
+        }
+        memcpy(carry + carrySize, begin, length);
+        carrySize += length;
+    }
+
+    void parseCarry() {
+        if (carryOverflow)
+            reject("edge record too long");
+        else
+            parseLine(carry, carry + carrySize);
+        carrySize = 0;
+        carryOverflow = false;
+    }
+
+    void parseLine(const char* p, const char* end) {
+        if (end > p && end[-1] == '\r')
+            --end;
+        if (p == end)
+            return;  // Blank lines are not records
+
+        int u, v;
+        double w;
+        if (parseVertex(p, end, u) && skipSeparator(p, end) && parseVertex(p, end, v) &&
+            skipSeparator(p, end) && parseWeight(p, end, w) && (skipBlanks(p, end), p == end))
+            store(u, v, w);
+        else
+            reject("malformed edge record");
+    }
+
+    static void skipBlanks(const char*& p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t'))
+            ++p;
+    }
+
+    static bool skipSeparator(const char*& p, const char* end) {
+        const char* start = p;
+        skipBlanks(p, end);
+        if (p < end && *p == ',')
+            ++p;
+        skipBlanks(p, end);
+        return p != start;
+    }
+
+    static bool parseVertex(const char*& p, const char* end, int& value) {
+        const char* start = p;
+        int64_t result = 0;
+        for (; p < end && unsigned(*p - '0') < 10; ++p) {
+            result = result * 10 + (*p - '0');
+            if (result > INT32_MAX)
+                return false;
+        }
+        value = int(result);
+        return p != start;
+    }
+
+    // Plain decimals with up to 15 significant digits are exact in a double, so one division by
+    // an exact power of ten rounds correctly. Anything else (exponents, long mantissas) goes
+    // through strtod on a terminated copy of the token.
+    static bool parseWeight(const char*& p, const char* end, double& value) {
+        static const double powersOf10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+                                            1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+        const char* start = p;
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative = *p++ == '-';
+
+        uint64_t mantissa = 0;
+        int digits = 0, fraction = 0;
+        for (; p < end && unsigned(*p - '0') < 10; ++p, ++digits)
+            mantissa = mantissa * 10 + uint64_t(*p - '0');
+        if (p < end && *p == '.') {
+            for (++p; p < end && unsigned(*p - '0') < 10; ++p, ++digits, ++fraction)
+                mantissa = mantissa * 10 + uint64_t(*p - '0');
+        }
+        if (digits == 0)
+            return false;
+
+        if (digits <= 15 && !(p < end && (*p == 'e' || *p == 'E'))) {
+            double result = double(mantissa) / powersOf10[fraction];
+            value = negative ? -result : result;
+            return true;
+        }
+
+        const char* tokenEnd = start;
+        while (tokenEnd < end && (unsigned(*tokenEnd - '0') < 10 || (*tokenEnd && strchr("+-.eE", *tokenEnd))))
+            ++tokenEnd;
+        char token[64];
+        size_t length = size_t(tokenEnd - start);
+        if (length >= sizeof(token))
+            return false;
+        memcpy(token, start, length);
+        token[length] = '\0';
+        char* stop;
+        value = strtod(token, &stop);
+        if (stop != token + length)
+            return false;
+        p = tokenEnd;
+        return true;
+    }
+
+    size_t consumeBinary(const char* data, size_t size) {
+        const size_t recordSize = format == Binary32 ? 12 : 16;
+        const char* p = data;
+        const char* end = data + size;
+
+        // Finish a record that started in the previous buffer
+        if (carrySize > 0 && seen < expected) {
+            size_t take = std::min(recordSize - carrySize, size);
+            memcpy(carry + carrySize, p, take);
+            carrySize += take;
+            p += take;
+            if (carrySize < recordSize)
+                return size;
+            decode(carry);
+            carrySize = 0;
+        }
+
+        while (seen < expected && size_t(end - p) >= recordSize) {
+            decode(p);
+            p += recordSize;
+        }
+
+        if (seen < expected && p < end) {
+            carrySize = size_t(end - p);
+            memcpy(carry, p, carrySize);
+            p = end;
+        }
+        return size_t(p - data);
+    }
+
+    void decode(const char* record) {
+        uint32_t u, v;
+        double w;
+        memcpy(&u, record, sizeof(u));
+        memcpy(&v, record + 4, sizeof(v));
+        if (format == Binary32) {
+            float narrow;
+            memcpy(&narrow, record + 8, sizeof(narrow));
+            w = narrow;
+        } else {
+            memcpy(&w, record + 8, sizeof(w));
+        }
+
+        if (u > uint32_t(INT32_MAX) || v > uint32_t(INT32_MAX))
+            reject("vertex id out of range");
+        else
+            store(int(u), int(v), w);
+    }
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+// Read-only structure-of-arrays view over an undirected edge list.
+// The view does not own anything: the arrays must outlive every solve that reads them.
+template <typename Index, typename Weight>
+struct BasicEdgeView {
+    const Index* sources = nullptr;
+    const Index* targets = nullptr;
+    const Weight* weights = nullptr;
+    size_t count = 0;
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+};
+
+// The graph's own storage: int vertex ids and double weights
+typedef BasicEdgeView<int, double> EdgeView;
+
+// Narrowest weight type that holds every weight of an edge list exactly
+enum WeightClass { IntegerWeights, FloatWeights, DoubleWeights };
+
+inline WeightClass classifyWeights(const EdgeView& edges) {
+    bool integral = true, single = true;
+    for (size_t i = 0; i < edges.count && (integral || single); ++i) {
+        double w = edges.weights[i];
+        integral = integral && w >= 0.0 && w <= double(UINT32_MAX) && w == std::floor(w);
+        single = single && double(float(w)) == w;  // NaN fails both tests
+    }
+    return integral ? IntegerWeights : single ? FloatWeights : DoubleWeights;
+}
+
+// Convert a weight to a solver's weight type, refusing values that type cannot hold exactly
+template <typename Weight, typename Source>
+inline Weight narrowWeight(Source w) {
+    if (std::is_same<Weight, Source>::value)
+        return Weight(w);
+    bool inRange = std::is_integral<Weight>::value
+                       ? w >= Source(std::numeric_limits<Weight>::lowest()) && w <= Source(std::numeric_limits<Weight>::max())
+                       : std::isinf(w) || std::fabs(w) <= Source(std::numeric_limits<Weight>::max());
+    if (!inRange || Source(Weight(w)) != w)
+        throw std::invalid_argument("Edge weight does not fit the solver's weight type.");
+    return Weight(w);
+}
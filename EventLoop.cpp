@@ -0,0 +1,394 @@
+#pragma once
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "Logger.cpp"
+#include "Metrics.cpp"
+#include "PayloadReader.cpp"
+
+// Edge-triggered epoll reactor with persistent, pipelined connections.
+// Clients send newline-delimited commands and may pipeline as many as they like per read.
+// Each connection has at most one command executing at a time, so its responses go back in
+// command order. Commands are handed to the CommandHandler (which runs them elsewhere, e.g. on
+// the thread pool); the worker reports back through complete(), which may be called from any
+// thread and wakes the loop through an eventfd. Partial reads and writes are buffered per
+// connection.
+// A connection whose queue of framed commands reaches maxQueuedCommands is not read from until
+// the queue drains, so a client pipelining faster than its commands run is held back by TCP flow
+// control instead of growing the queue without bound.
+// A command may be followed by a payload (e.g. bulk edge records): the PayloadHandler decides
+// that when the command is framed, and the bytes after it are fed to the returned reader straight
+// from the read buffer until it is done. The command is dispatched together with its payload.
+class EventLoop {
+public:
+    typedef std::function<void(uint64_t connectionId, std::string command, std::shared_ptr<PayloadReader> payload)>
+        CommandHandler;
+    typedef std::function<std::shared_ptr<PayloadReader>(const std::string& command)> PayloadHandler;
+
+    EventLoop(int port, CommandHandler handler, PayloadHandler payloadFor = nullptr, size_t maxLineLength = 1 << 20,
+              size_t maxQueuedCommands = 1024)
+        : handler(std::move(handler)), payloadFor(std::move(payloadFor)), maxLineLength(maxLineLength),
+          maxQueuedCommands(maxQueuedCommands), nextConnectionId(FirstConnectionId), events(256) {
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0)
+            fail("Socket failed");
+
+        int opt = 1;
+        if (setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR | SO_REUSEPORT, &opt, sizeof(opt)))
+            fail("setsockopt failed");
+
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = INADDR_ANY;
+        address.sin_port = htons(port);
+        if (bind(listenFd, (struct sockaddr*)&address, sizeof(address)) < 0)
+            fail("Bind failed");
+        if (listen(listenFd, SOMAXCONN) < 0)
+            fail("Listen failed");
+
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (wakeFd < 0 || epollFd < 0)
+            fail("epoll setup failed");
+
+        watch(listenFd, ListenerId, EPOLLIN | EPOLLET);
+        watch(wakeFd, WakeId, EPOLLIN | EPOLLET);
+    }
+
+    ~EventLoop() {
+        for (auto& entry : connections)
+            close(entry.second->fd);
+        close(epollFd);
+        close(wakeFd);
+        close(listenFd);
+    }
+
+    // Runs the loop on the calling thread; never returns
+    void run() {
+        while (true)
+            runOnce(-1);
+    }
+
+    // Waits up to timeoutMs (-1: indefinitely) for events and handles them; run() in steps, so a
+    // test can drive the loop from its own thread
+    void runOnce(int timeoutMs) {
+        int ready = epoll_wait(epollFd, events.data(), int(events.size()), timeoutMs);
+        if (ready < 0) {
+            if (errno == EINTR)
+                return;
+            fail("epoll_wait failed");
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            uint64_t id = events[i].data.u64;
+            if (id == ListenerId) {
+                acceptAll();
+            } else if (id == WakeId) {
+                drainCompletions();
+            } else {
+                auto it = connections.find(id);
+                if (it == connections.end())
+                    continue;
+                Connection& connection = *it->second;
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    closeConnection(connection);
+                    continue;
+                }
+                if (events[i].events & EPOLLIN)
+                    readAll(connection);
+                if (events[i].events & EPOLLOUT)
+                    flush(connection);
+                finishIfDone(id);
+            }
+        }
+    }
+
+    // Serve an already connected stream socket (e.g. one end of a socketpair) like an accepted
+    // client; the loop owns the descriptor from now on. Returns the connection id.
+    uint64_t adopt(int fd) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        return addConnection(fd);
+    }
+
+    // Deliver the response for a connection's in-flight command. Safe from any thread.
+    void complete(uint64_t connectionId, std::string response) {
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            completions.push_back({connectionId, std::move(response)});
+        }
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd, &one, sizeof(one));
+        (void)written;  // EAGAIN means the counter is already non-zero: the loop will wake anyway
+    }
+
+private:
+    struct Request {
+        std::string command;
+        std::shared_ptr<PayloadReader> payload;  // nullptr for plain commands
+    };
+
+    struct Connection {
+        uint64_t id;
+        int fd;
+        std::string input;                       // Bytes read but not yet framed into a command
+        Request reading;                         // Command whose payload is still arriving
+        std::deque<Request> commands;            // Framed commands waiting for their turn
+        bool busy = false;                       // A command from this connection is executing
+        bool paused = false;                     // Not read from until `commands` drains
+        bool peerClosed = false;
+        std::string output;                // Responses not yet written
+        size_t outputOffset = 0;
+    };
+
+    static const uint64_t ListenerId = 0;
+    static const uint64_t WakeId = 1;
+    static const uint64_t FirstConnectionId = 2;
+
+    CommandHandler handler;
+    PayloadHandler payloadFor;
+    size_t maxLineLength;
+    size_t maxQueuedCommands;
+    uint64_t nextConnectionId;
+    int listenFd;
+    int wakeFd;
+    int epollFd;
+    std::vector<struct epoll_event> events;
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections;
+
+    std::mutex completionMutex;
+    std::vector<std::pair<uint64_t, std::string>> completions;
+
+    static void fail(const char* what) {
+        perror(what);
+        exit(EXIT_FAILURE);
+    }
+
+    void watch(int fd, uint64_t id, uint32_t events) {
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = events;
+        event.data.u64 = id;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+            fail("epoll_ctl failed");
+    }
+
+    void acceptAll() {
+        while (true) {
+            Metrics::Clock::time_point start = Metrics::Clock::now();
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    return;
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+                // e.g. EMFILE: keep serving the connections we have
+                Logger::warning("Accept failed: ", strerror(errno));
+                return;
+            }
+
+            addConnection(fd);
+            Metrics::record(Metrics::Accept, Metrics::Clock::now() - start);
+            Metrics::add(Metrics::ConnectionsAccepted);
+        }
+    }
+
+    uint64_t addConnection(int fd) {
+        std::unique_ptr<Connection> connection(new Connection());
+        uint64_t id = nextConnectionId++;
+        connection->id = id;
+        connection->fd = fd;
+        watch(fd, id, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET);
+        Logger::debug("Connection ", id, " accepted");
+        connections[id] = std::move(connection);
+        return id;
+    }
+
+    // Edge-triggered: read until the socket is empty, framing each chunk as it arrives. Stops
+    // early while the command queue is full; drainCompletions() resumes once it has drained.
+    void readAll(Connection& connection) {
+        Metrics::Clock::time_point start = Metrics::Clock::now();
+        char buffer[65536];
+        uint64_t received = 0;
+        connection.paused = false;
+        while (!connection.peerClosed) {
+            if (connection.commands.size() >= maxQueuedCommands) {
+                connection.paused = true;
+                break;
+            }
+            ssize_t n = read(connection.fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                received += uint64_t(n);
+                frame(connection, buffer, size_t(n));
+                continue;
+            }
+            if (n == 0) {
+                connection.peerClosed = true;
+                break;
+            }
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                connection.peerClosed = true;
+            break;
+        }
+
+        if (connection.peerClosed) {
+            // A final command without a trailing newline still counts once the client stops sending
+            if (!connection.input.empty()) {
+                std::string command;
+                command.swap(connection.input);
+                pushCommand(connection, std::move(command));
+            }
+            if (connection.reading.payload) {
+                connection.reading.payload->endOfInput();
+                connection.commands.push_back(std::move(connection.reading));
+            }
+        }
+        Metrics::record(Metrics::Read, Metrics::Clock::now() - start);
+        Metrics::add(Metrics::BytesRead, received);
+        dispatch(connection);
+    }
+
+    // Split incoming bytes into commands. Payload bytes go to the pending command's reader
+    // without being copied; only an incomplete command line is buffered.
+    void frame(Connection& connection, const char* data, size_t size) {
+        while (size > 0) {
+            if (connection.reading.payload) {
+                size_t used = connection.reading.payload->consume(data, size);
+                data += used;
+                size -= used;
+                if (connection.reading.payload->done())
+                    connection.commands.push_back(std::move(connection.reading));
+                continue;
+            }
+
+            const char* newline = static_cast<const char*>(memchr(data, '\n', size));
+            size_t length = newline ? size_t(newline - data) : size;
+            if (connection.input.size() + length > maxLineLength) {
+                connection.input.clear();
+                connection.output += "Error: command too long\n";
+                connection.peerClosed = true;
+                return;
+            }
+            connection.input.append(data, length);
+            if (!newline)
+                return;
+
+            std::string command;
+            command.swap(connection.input);
+            pushCommand(connection, std::move(command));
+            data += length + 1;
+            size -= length + 1;
+        }
+    }
+
+    void pushCommand(Connection& connection, std::string command) {
+        if (!command.empty() && command.back() == '\r')
+            command.pop_back();
+        if (command.empty())
+            return;
+
+        std::shared_ptr<PayloadReader> payload = payloadFor ? payloadFor(command) : nullptr;
+        if (payload && !payload->done()) {
+            connection.reading = Request{std::move(command), std::move(payload)};
+            return;
+        }
+        connection.commands.push_back(Request{std::move(command), std::move(payload)});
+    }
+
+    void dispatch(Connection& connection) {
+        if (connection.busy || connection.commands.empty())
+            return;
+        connection.busy = true;
+        Request request = std::move(connection.commands.front());
+        connection.commands.pop_front();
+        handler(connection.id, std::move(request.command), std::move(request.payload));
+    }
+
+    void drainCompletions() {
+        uint64_t counter;
+        while (read(wakeFd, &counter, sizeof(counter)) > 0) {
+        }
+
+        std::vector<std::pair<uint64_t, std::string>> batch;
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            batch.swap(completions);
+        }
+
+        for (auto& completion : batch) {
+            auto it = connections.find(completion.first);
+            if (it == connections.end())
+                continue;  // The client went away while its command was running
+            Connection& connection = *it->second;
+            connection.output += completion.second;
+            connection.busy = false;
+            flush(connection);
+            dispatch(connection);
+            if (connection.paused && connection.commands.size() < maxQueuedCommands)
+                readAll(connection);  // Nothing re-arms the edge: catch up on what arrived meanwhile
+            finishIfDone(completion.first);
+        }
+    }
+
+    // Write as much pending output as the socket takes; EPOLLOUT resumes the rest
+    void flush(Connection& connection) {
+        if (connection.outputOffset == connection.output.size())
+            return;
+        Metrics::Timer timer(Metrics::Send);
+        while (connection.outputOffset < connection.output.size()) {
+            ssize_t n = send(connection.fd, connection.output.data() + connection.outputOffset,
+                             connection.output.size() - connection.outputOffset, MSG_NOSIGNAL);
+            if (n > 0) {
+                connection.outputOffset += size_t(n);
+                Metrics::add(Metrics::BytesWritten, uint64_t(n));
+                continue;
+            }
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return;
+            // The peer is gone: drop what we cannot deliver
+            connection.output.clear();
+            connection.outputOffset = 0;
+            connection.commands.clear();
+            connection.peerClosed = true;
+            return;
+        }
+        connection.output.clear();
+        connection.outputOffset = 0;
+    }
+
+    // Close once the client has stopped sending and every response has been written
+    void finishIfDone(uint64_t id) {
+        auto it = connections.find(id);
+        if (it == connections.end())
+            return;
+        Connection& connection = *it->second;
+        if (connection.peerClosed && !connection.busy && connection.commands.empty() && connection.output.empty())
+            closeConnection(connection);
+    }
+
+    void closeConnection(Connection& connection) {
+        uint64_t id = connection.id;
+        close(connection.fd);  // Also removes it from the epoll set
+        connections.erase(id);
+    }
+};
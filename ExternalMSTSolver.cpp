@@ -0,0 +1,370 @@
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "IMSTSolver.cpp"
+#include "ParallelSort.cpp"
+
+// Out-of-core Kruskal for edge files larger than RAM.
+// The input holds the packed binary records of a "Newgraph n,m,f32|f64" payload: u32 source,
+// u32 target and an f32 or f64 weight. The solve runs in two phases under one memory budget:
+//  1. Sort: the file is read in runs that fill half the budget, each run is sorted by weight in
+//     parallel (the other half is the sort's merge buffer) and spilled to the spill directory.
+//  2. Merge: the runs are merged in weight order through per-run read buffers, and the merged
+//     stream feeds Kruskal's union-find, the only per-vertex state in RAM (4 bytes per vertex).
+//     If there are more runs than read buffers fit in the budget, groups of runs are first merged
+//     into longer runs. The merge stops as soon as the forest spans every vertex seen.
+// So a 100 GB f64 file (6.25G edges) with a 6 GB budget is about 33 runs and a single merge pass.
+class ExternalMSTSolver {
+public:
+    enum Format { Binary32, Binary64 };
+
+    struct Progress {
+        const char* phase;     // "sort", "merge" (intermediate passes) or "kruskal" (final pass)
+        uint64_t done;         // Bytes read while sorting, records consumed while merging
+        uint64_t total;
+        size_t runs;           // Sorted runs on disk
+        uint64_t forestEdges;  // Edges emitted so far (final pass)
+    };
+
+    struct Options {
+        std::string spillDirectory = "/tmp";
+        size_t memoryBudget = size_t(1) << 30;  // Run buffers, merge buffers and the union-find
+        unsigned numThreads = defaultSolverThreads();
+        std::function<void(const Progress&)> progress;  // After every run and every few million records
+    };
+
+    struct Summary {
+        int numVertices = 0;  // Largest vertex id + 1
+        uint64_t numEdges = 0;  // Records in the file, self-loops included
+        uint64_t forestEdges = 0;
+        double totalWeight = 0.0;
+        size_t runs = 0;
+        int mergePasses = 0;
+    };
+
+    typedef std::function<void(int u, int v, double weight)> EdgeSink;
+
+    ExternalMSTSolver() {}
+
+    explicit ExternalMSTSolver(const Options& options) : options(options) {}
+
+    // Stream the file and hand every minimum spanning forest edge to sink, in weight order
+    Summary solve(const std::string& path, Format format, const EdgeSink& sink) {
+        return format == Binary32 ? run<float>(path, sink) : run<double>(path, sink);
+    }
+
+    // Collect the forest in memory (it has fewer edges than there are vertices)
+    Summary solve(const std::string& path, Format format, MSTResult& result) {
+        result.clear();
+        return solve(path, format, [&result](int u, int v, double weight) { result.add(u, v, weight); });
+    }
+
+private:
+    static constexpr size_t MinReadBuffer = size_t(1) << 20;  // Per run while merging
+    static constexpr uint64_t ReportInterval = uint64_t(1) << 22;
+
+    Options options;
+
+    // Same layout as the file's packed records
+    template <typename Weight>
+    struct Record {
+        uint32_t u;
+        uint32_t v;
+        Weight weight;
+    };
+
+    typedef std::unique_ptr<FILE, int (*)(FILE*)> File;
+
+    static File openFile(const std::string& path, const char* mode) {
+        File file(fopen(path.c_str(), mode), fclose);
+        if (!file)
+            throw std::runtime_error("cannot open " + path + ": " + strerror(errno));
+        return file;
+    }
+
+    // Private directory under the spill directory, removed with everything in it
+    class SpillArea {
+    public:
+        explicit SpillArea(const std::string& parent) : next(0) {
+            std::string pattern = parent + "/mst-spill-XXXXXX";
+            std::vector<char> name(pattern.begin(), pattern.end());
+            name.push_back('\0');
+            if (!mkdtemp(name.data()))
+                throw std::runtime_error("cannot create a spill directory in " + parent + ": " + strerror(errno));
+            directory = name.data();
+        }
+
+        ~SpillArea() {
+            for (const std::string& file : files)
+                unlink(file.c_str());
+            rmdir(directory.c_str());
+        }
+
+        std::string newFile() {
+            files.push_back(directory + "/run-" + std::to_string(next++));
+            return files.back();
+        }
+
+        void remove(const std::string& file) {
+            unlink(file.c_str());
+            files.erase(std::find(files.begin(), files.end(), file));
+        }
+
+    private:
+        std::string directory;
+        std::vector<std::string> files;
+        size_t next;
+    };
+
+    // Buffered sequential reader over one sorted run
+    template <typename Weight>
+    class RunReader {
+    public:
+        RunReader(const std::string& path, size_t bufferRecords)
+            : file(openFile(path, "rb")), buffer(new Record<Weight>[bufferRecords]), capacity(bufferRecords),
+              size(0), position(0) {}
+
+        bool next(Record<Weight>& record) {
+            if (position == size) {
+                size = fread(buffer.get(), sizeof(Record<Weight>), capacity, file.get());
+                position = 0;
+                if (size == 0) {
+                    if (ferror(file.get()))
+                        throw std::runtime_error(std::string("cannot read a spilled run: ") + strerror(errno));
+                    return false;
+                }
+            }
+            record = buffer[position++];
+            return true;
+        }
+
+    private:
+        File file;
+        std::unique_ptr<Record<Weight>[]> buffer;
+        size_t capacity;
+        size_t size;
+        size_t position;
+    };
+
+    // Union-find over 32-bit parents only. Roots are linked by a fixed pseudo-random priority
+    // instead of by rank, which keeps trees shallow in expectation without a rank array.
+    class CompactUnionFind {
+    public:
+        explicit CompactUnionFind(size_t numVertices) : parent(new uint32_t[numVertices]) {
+            for (size_t i = 0; i < numVertices; ++i)
+                parent[i] = uint32_t(i);
+        }
+
+        uint32_t find(uint32_t x) {
+            while (parent[x] != x) {
+                parent[x] = parent[parent[x]];  // Path halving
+                x = parent[x];
+            }
+            return x;
+        }
+
+        bool unite(uint32_t x, uint32_t y) {
+            x = find(x);
+            y = find(y);
+            if (x == y)
+                return false;
+            if (priority(x) > priority(y))
+                std::swap(x, y);
+            parent[x] = y;
+            return true;
+        }
+
+    private:
+        std::unique_ptr<uint32_t[]> parent;
+
+        static uint32_t priority(uint32_t x) {
+            x ^= x >> 16;
+            x *= 0x7feb352dU;
+            x ^= x >> 15;
+            x *= 0x846ca68bU;
+            return x ^ (x >> 16);
+        }
+    };
+
+    void report(const char* phase, uint64_t done, uint64_t total, size_t runs, uint64_t forestEdges) const {
+        if (options.progress)
+            options.progress(Progress{phase, done, total, runs, forestEdges});
+    }
+
+    template <typename Weight>
+    Summary run(const std::string& path, const EdgeSink& sink) {
+        typedef Record<Weight> Edge;
+        static_assert(sizeof(Edge) == 8 + sizeof(Weight), "records must match the packed file layout");
+
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+            throw std::runtime_error("cannot open " + path + ": " + strerror(errno));
+        uint64_t fileBytes = uint64_t(info.st_size);
+        if (fileBytes % sizeof(Edge) != 0)
+            throw std::runtime_error(path + " does not hold whole edge records");
+
+        size_t runRecords = options.memoryBudget / (2 * sizeof(Edge));
+        if (runRecords < 1024)
+            throw std::invalid_argument("memory budget too small");
+
+        Summary summary;
+        SpillArea spill(options.spillDirectory);
+        std::vector<std::string> runs;
+        uint64_t edgesLeft = 0;  // Records that made it into a run
+        uint32_t maxVertex = 0;
+        bool anyVertex = false;
+
+        // Phase 1: sorted runs
+        {
+            File input = openFile(path, "rb");
+            std::unique_ptr<Edge[]> data(new Edge[runRecords]);
+            std::unique_ptr<Edge[]> scratch(new Edge[runRecords]);
+            auto lighter = [](const Edge& a, const Edge& b) { return a.weight < b.weight; };
+            uint64_t bytesRead = 0;
+            while (true) {
+                size_t count = fread(data.get(), sizeof(Edge), runRecords, input.get());
+                if (count == 0) {
+                    if (ferror(input.get()))
+                        throw std::runtime_error("cannot read " + path + ": " + strerror(errno));
+                    break;
+                }
+                bytesRead += count * sizeof(Edge);
+                summary.numEdges += count;
+
+                size_t kept = 0;
+                for (size_t i = 0; i < count; ++i) {
+                    const Edge& edge = data[i];
+                    if (edge.u > uint32_t(INT_MAX - 1) || edge.v > uint32_t(INT_MAX - 1))
+                        throw std::runtime_error(path + ": vertex id out of range in record " +
+                                                 std::to_string(summary.numEdges - count + i + 1));
+                    maxVertex = std::max(maxVertex, std::max(edge.u, edge.v));
+                    anyVertex = true;
+                    if (edge.u != edge.v)
+                        data[kept++] = edge;  // Self-loops never join a forest
+                }
+
+                parallelSort(data.get(), kept, options.numThreads, lighter, scratch.get());
+                runs.push_back(spill.newFile());
+                writeRecords(runs.back(), data.get(), kept);
+                edgesLeft += kept;
+                report("sort", bytesRead, fileBytes, runs.size(), 0);
+            }
+        }
+        summary.runs = runs.size();
+        summary.numVertices = anyVertex ? int(maxVertex) + 1 : 0;
+
+        // Phase 2: merge passes until the final one fits beside the union-find
+        size_t unionFindBytes = size_t(summary.numVertices) * sizeof(uint32_t);
+        if (unionFindBytes + 2 * MinReadBuffer > options.memoryBudget)
+            throw std::invalid_argument("memory budget too small for " + std::to_string(summary.numVertices) +
+                                        " vertices");
+        size_t finalFanIn = std::max<size_t>(2, (options.memoryBudget - unionFindBytes) / MinReadBuffer);
+        size_t passFanIn = std::max<size_t>(2, options.memoryBudget / MinReadBuffer - 1);  // One for the output
+        while (runs.size() > finalFanIn) {
+            std::vector<std::string> merged;
+            uint64_t consumed = 0;
+            for (size_t first = 0; first < runs.size(); first += passFanIn) {
+                std::vector<std::string> group(runs.begin() + first,
+                                               runs.begin() + std::min(runs.size(), first + passFanIn));
+                merged.push_back(spill.newFile());
+                File output = openFile(merged.back(), "wb");
+                std::vector<Edge> pending;
+                pending.reserve(MinReadBuffer / sizeof(Edge));
+                mergeRuns<Weight>(group, options.memoryBudget / (group.size() + 1), [&](const Edge& edge) {
+                    pending.push_back(edge);
+                    if (pending.size() == pending.capacity()) {
+                        writeBlock(output.get(), merged.back(), pending.data(), pending.size());
+                        pending.clear();
+                    }
+                    if (++consumed % ReportInterval == 0)
+                        report("merge", consumed, edgesLeft, runs.size(), 0);
+                    return true;
+                });
+                writeBlock(output.get(), merged.back(), pending.data(), pending.size());
+                if (fclose(output.release()) != 0)
+                    throw std::runtime_error("cannot write " + merged.back() + ": " + strerror(errno));
+                for (const std::string& run : group)
+                    spill.remove(run);
+            }
+            runs.swap(merged);
+            summary.mergePasses++;
+            report("merge", consumed, edgesLeft, runs.size(), 0);
+        }
+
+        // Final pass: Kruskal over the merged stream
+        CompactUnionFind components(size_t(summary.numVertices));
+        uint64_t treeEdges = summary.numVertices > 0 ? uint64_t(summary.numVertices) - 1 : 0;
+        uint64_t consumed = 0;
+        size_t readBuffer = runs.empty() ? 0 : (options.memoryBudget - unionFindBytes) / runs.size();
+        mergeRuns<Weight>(runs, readBuffer, [&](const Edge& edge) {
+            if (components.unite(edge.u, edge.v)) {
+                sink(int(edge.u), int(edge.v), double(edge.weight));
+                summary.forestEdges++;
+                summary.totalWeight += double(edge.weight);
+            }
+            if (++consumed % ReportInterval == 0)
+                report("kruskal", consumed, edgesLeft, runs.size(), summary.forestEdges);
+            return summary.forestEdges < treeEdges;  // A spanning tree cannot grow any further
+        });
+        summary.mergePasses++;
+        report("kruskal", consumed, edgesLeft, runs.size(), summary.forestEdges);
+        return summary;
+    }
+
+    // K-way merge by weight; onEdge returns false to stop early
+    template <typename Weight, typename Fn>
+    static void mergeRuns(const std::vector<std::string>& runs, size_t bufferBytes, Fn&& onEdge) {
+        typedef Record<Weight> Edge;
+        size_t bufferRecords = std::max<size_t>(1, bufferBytes / sizeof(Edge));
+        std::vector<std::unique_ptr<RunReader<Weight>>> readers;
+        std::vector<std::pair<Edge, size_t>> heap;  // Head record of each run that still has one
+        for (const std::string& run : runs) {
+            readers.emplace_back(new RunReader<Weight>(run, bufferRecords));
+            Edge head;
+            if (readers.back()->next(head))
+                heap.push_back({head, readers.size() - 1});
+        }
+
+        auto heavier = [](const std::pair<Edge, size_t>& a, const std::pair<Edge, size_t>& b) {
+            return a.first.weight > b.first.weight;
+        };
+        std::make_heap(heap.begin(), heap.end(), heavier);
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), heavier);
+            std::pair<Edge, size_t>& top = heap.back();
+            if (!onEdge(top.first))
+                return;
+            if (readers[top.second]->next(top.first))
+                std::push_heap(heap.begin(), heap.end(), heavier);
+            else
+                heap.pop_back();
+        }
+    }
+
+    template <typename Edge>
+    static void writeRecords(const std::string& path, const Edge* data, size_t count) {
+        File output = openFile(path, "wb");
+        writeBlock(output.get(), path, data, count);
+        if (fclose(output.release()) != 0)
+            throw std::runtime_error("cannot write " + path + ": " + strerror(errno));
+    }
+
+    template <typename Edge>
+    static void writeBlock(FILE* file, const std::string& path, const Edge* data, size_t count) {
+        if (count > 0 && fwrite(data, sizeof(Edge), count, file) != count)
+            throw std::runtime_error("cannot write " + path + ": " + strerror(errno));
+    }
+};
@@ -0,0 +1,71 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "ExternalMSTSolver.cpp"
+
+// Command-line driver: ExternalMSTTool edge-file f32|f64 [--spill dir] [--memory bytes[K|M|G]]
+//                                                     [--threads N] [--output forest-file]
+// The forest is written as "u,v,w" lines, the text records a Newgraph payload accepts.
+int main(int argc, char* argv[]) {
+    ExternalMSTSolver::Options options;
+    const char* output = nullptr;
+    bool usage = argc < 3 || (strcmp(argv[2], "f32") != 0 && strcmp(argv[2], "f64") != 0);
+    for (int i = 3; i < argc && !usage; ++i) {
+        if (strcmp(argv[i], "--spill") == 0 && i + 1 < argc) {
+            options.spillDirectory = argv[++i];
+        } else if (strcmp(argv[i], "--memory") == 0 && i + 1 < argc) {
+            char* suffix;
+            options.memoryBudget = strtoull(argv[++i], &suffix, 10);
+            if (*suffix == 'K' || *suffix == 'k')
+                options.memoryBudget <<= 10;
+            else if (*suffix == 'M' || *suffix == 'm')
+                options.memoryBudget <<= 20;
+            else if (*suffix == 'G' || *suffix == 'g')
+                options.memoryBudget <<= 30;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.numThreads = unsigned(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            usage = true;
+        }
+    }
+    if (usage) {
+        std::cerr << "Usage: " << argv[0] << " edge-file f32|f64 [--spill dir] [--memory bytes[K|M|G]]"
+                  << " [--threads N] [--output forest-file]" << std::endl;
+        return 1;
+    }
+
+    options.progress = [](const ExternalMSTSolver::Progress& progress) {
+        std::cerr << progress.phase << ": " << progress.done << "/" << progress.total << ", " << progress.runs
+                  << " runs, " << progress.forestEdges << " forest edges" << std::endl;
+    };
+
+    try {
+        FILE* forest = output ? fopen(output, "w") : nullptr;
+        if (output && !forest)
+            throw std::runtime_error(std::string("cannot create ") + output + ": " + strerror(errno));
+        ExternalMSTSolver solver(options);
+        ExternalMSTSolver::Format format = strcmp(argv[2], "f32") == 0 ? ExternalMSTSolver::Binary32
+                                                                         : ExternalMSTSolver::Binary64;
+        ExternalMSTSolver::Summary summary = solver.solve(argv[1], format, [forest](int u, int v, double weight) {
+            if (forest)
+                fprintf(forest, "%d,%d,%.17g\n", u, v, weight);
+        });
+        if (forest && fclose(forest) != 0)
+            throw std::runtime_error(std::string("cannot write ") + output + ": " + strerror(errno));
+
+        std::cout << "Vertices: " << summary.numVertices << "\nEdges: " << summary.numEdges
+                  << "\nForest edges: " << summary.forestEdges << "\nTotal weight: " << summary.totalWeight
+                  << "\nRuns: " << summary.runs << "\nMerge passes: " << summary.mergePasses << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,39 +1,106 @@
-#include <unordered_map>
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
 #include <vector>
-#include <list>
 #include <iostream>
+#include "EdgeIndex.cpp"
+
+// Non-owning view of one vertex's neighbors as (neighbor vertex, weight) pairs.
+// Valid until the next edit of the graph.
+struct NeighborView {
+    const std::pair<int, double>* neighbors;
+    size_t count;
+
+    const std::pair<int, double>* begin() const {
+        return neighbors;
+    }
+
+    const std::pair<int, double>* end() const {
+        return neighbors + count;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    const std::pair<int, double>& operator[](size_t i) const {
+        return neighbors[i];
+    }
+};
 
 class Graph {
 private:
-    // Adjacency list: each vertex maps to a list of pairs (neighbor vertex, weight)
-    std::unordered_map<int, std::list<std::pair<int, double>>> adjList;
+    // Adjacency list: each vertex has a contiguous array of pairs (neighbor vertex, weight)
+    std::vector<std::vector<std::pair<int, double>>> adjList;
+    // (u, v) -> position of v in adjList[u], so edits and lookups never scan a list
+    EdgeIndex edgeIndex;
     int numVertices;
     int numEdges;
 
+    void checkVertex(int u) const {
+        if (u < 0 || u >= numVertices)
+            throw std::out_of_range("Vertex out of range.");
+    }
+
 public:
-    Graph(int numVertices) : numVertices(numVertices), numEdges(0) {}
+    Graph(int numVertices) : adjList(numVertices), numVertices(numVertices), numEdges(0) {}
 
-    // Add a directed edge from vertex u to vertex v with weight w
+    // Add a directed edge from vertex u to vertex v with weight w.
+    // If the edge already exists, only its weight is updated.
     void addEdge(int u, int v, double w) {
+        checkVertex(u);
+        checkVertex(v);
+        size_t position = edgeIndex.find(u, v);
+        if (position != EdgeIndex::NotFound) {
+            adjList[u][position].second = w;
+            return;
+        }
+        edgeIndex.set(u, v, adjList[u].size());
         adjList[u].push_back(std::make_pair(v, w));
         numEdges++;
     }
 
-    // Remove an edge from u to v
-    void removeEdge(int u, int v) {
-        auto& neighbors = adjList[u];
-        neighbors.remove_if([v](const std::pair<int, double>& edge) {
-            return edge.first == v;
-        });
+    // Remove the edge from u to v; false if there is none.
+    // The last neighbor of u takes the removed one's place, so neighbor order is not kept.
+    bool removeEdge(int u, int v) {
+        if (u < 0 || u >= numVertices || v < 0 || v >= numVertices)
+            return false;
+        size_t position = edgeIndex.find(u, v);
+        if (position == EdgeIndex::NotFound)
+            return false;
+
+        edgeIndex.erase(u, v);
+        std::vector<std::pair<int, double>>& neighbors = adjList[u];
+        if (position + 1 != neighbors.size()) {
+            neighbors[position] = neighbors.back();
+            edgeIndex.set(u, neighbors[position].first, position);
+        }
+        neighbors.pop_back();
         numEdges--;
+        return true;
     }
 
-    // Get all the neighbors of a given vertex
-    std::list<std::pair<int, double>> getNeighbors(int u) const {
-        if (adjList.find(u) != adjList.end()) {
-            return adjList.at(u);
-        }
-        return std::list<std::pair<int, double>>();  // Return empty list if u is not found
+    // Weight of the edge from u to v; false if there is none
+    bool getWeight(int u, int v, double& w) const {
+        if (u < 0 || u >= numVertices || v < 0 || v >= numVertices)
+            return false;
+        size_t position = edgeIndex.find(u, v);
+        if (position == EdgeIndex::NotFound)
+            return false;
+        w = adjList[u][position].second;
+        return true;
+    }
+
+    // Get all the neighbors of a given vertex, without copying them
+    NeighborView getNeighbors(int u) const {
+        if (u < 0 || u >= numVertices)
+            return NeighborView{nullptr, 0};  // Empty view if u is not a vertex
+        return NeighborView{adjList[u].data(), adjList[u].size()};
     }
 
     // Get the number of vertices in the graph
@@ -46,22 +113,3 @@ public:
         return numEdges;
     }
 };
-
-//example usage
-int main() {
-    Graph graph(5);  // Create a graph with 5 vertices
-
-    // Add directed edges with weights
-    graph.addEdge(0, 1, 10.0);
-    graph.addEdge(0, 3, 5.0);
-    graph.addEdge(1, 2, 1.0);
-    graph.addEdge(3, 4, 2.0);
-
-    // Retrieve neighbors of vertex 0
-    for (const auto& neighbor : graph.getNeighbors(0)) {
-        std::cout << "Vertex 0 has neighbor " << neighbor.first << " with weight " << neighbor.second << std::endl;
-    }
-
-    return 0;
-}
-
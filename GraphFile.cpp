@@ -0,0 +1,206 @@
+#pragma once
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "IMSTSolver.cpp"
+
+// Minimum spanning forest stored in a graph file, read in place from the mapping
+struct StoredForest {
+    bool present = false;
+    const WeightedEdge* edges = nullptr;
+    size_t count = 0;
+    double totalWeight = 0.0;
+    std::shared_ptr<const void> mapping;
+
+    void copyTo(MSTResult& result) const {
+        result.clear();
+        result.edges.assign(edges, edges + count);
+        result.totalWeight = totalWeight;
+    }
+};
+
+// Versioned binary graph file that is used in place after mmap, without parsing:
+//   header | offsets | targets | weights | [forest]
+// Each section holds a compacted CSRGraph array exactly as it is laid out in memory and starts at
+// a 64-byte aligned file offset recorded in the header. Values are in host byte order; the header
+// carries a byte-order marker, so a file from a host of the other endianness is rejected rather
+// than misread. Loading checks the header and section bounds, that the offsets never decrease, that
+// every vertex id is in range and that the edge count matches the u <= v slots (one pass over the
+// arrays), so a damaged or hostile file is rejected instead of sending CSRGraph out of bounds.
+class GraphFile {
+public:
+    static const uint32_t FormatVersion = 2;
+    static const int SectionCount = 4;
+
+    // The file starts with this header
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t numVertices;
+        uint64_t numSlots;     // Directed adjacency entries, offsets[numVertices]
+        uint64_t numEdges;     // Undirected edges: slots with u <= target
+        uint32_t hasForest;
+        uint32_t reserved;
+        uint64_t forestEdges;
+        double forestWeight;
+        uint64_t sections[SectionCount];  // File offsets of the arrays, in the order listed above
+    };
+
+    struct Loaded {
+        CSRGraph graph;  // Reads the mapped arrays; the mapping lives as long as any copy of it
+        StoredForest forest;
+    };
+
+    // Write the graph and, if given, its minimum spanning forest. The data goes to a temporary
+    // file that is renamed over `path`, so a reader never maps a half-written file.
+    static void save(const std::string& path, CSRGraph graph, const MSTResult* forest) {
+        graph.compact();
+        int n = graph.numVertices();
+
+        Header header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, Magic, sizeof(header.magic));
+        header.version = FormatVersion;
+        header.byteOrder = ByteOrderMarker;
+        header.numVertices = uint64_t(n);
+        header.numSlots = graph.offsetData()[n];
+        header.numEdges = graph.compactedEdges();
+        if (forest) {
+            header.hasForest = 1;
+            header.forestEdges = forest->edges.size();
+            header.forestWeight = forest->totalWeight;
+        }
+
+        const void* data[SectionCount] = {graph.offsetData(), graph.targetData(), graph.weightData(),
+                                          forest ? forest->edges.data() : nullptr};
+        uint64_t bytes[SectionCount] = {(header.numVertices + 1) * sizeof(size_t), header.numSlots * sizeof(int),
+                                        header.numSlots * sizeof(double), header.forestEdges * sizeof(WeightedEdge)};
+        uint64_t position = align(sizeof(Header));
+        for (int s = 0; s < SectionCount; ++s) {
+            header.sections[s] = position;
+            position = align(position + bytes[s]);
+        }
+
+        std::string temporary = path + ".tmp";
+        FILE* file = fopen(temporary.c_str(), "wb");
+        if (!file)
+            throw std::runtime_error("cannot create " + temporary + ": " + strerror(errno));
+
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+        uint64_t written = sizeof(header);
+        static const char padding[Alignment] = {};
+        for (int s = 0; ok && s < SectionCount; ++s) {
+            ok = fwrite(padding, 1, header.sections[s] - written, file) == header.sections[s] - written;
+            if (ok && bytes[s] > 0)
+                ok = fwrite(data[s], 1, bytes[s], file) == bytes[s];
+            written = header.sections[s] + bytes[s];
+        }
+        ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+        int error = errno;
+        ok = fclose(file) == 0 && ok;
+        if (!ok || rename(temporary.c_str(), path.c_str()) != 0) {
+            error = ok ? errno : error;
+            unlink(temporary.c_str());
+            throw std::runtime_error("cannot write " + path + ": " + strerror(error));
+        }
+    }
+
+    // Map the file read-only; the graph's arrays point straight into the mapping
+    static Loaded load(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw std::runtime_error("cannot open " + path + ": " + strerror(errno));
+        struct stat info;
+        if (fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(Header)) {
+            close(fd);
+            throw std::runtime_error(path + " is not a graph file");
+        }
+
+        size_t size = size_t(info.st_size);
+        void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);  // The mapping stays valid without the descriptor
+        if (address == MAP_FAILED)
+            throw std::runtime_error("cannot map " + path + ": " + strerror(errno));
+        std::shared_ptr<const void> mapping(address, [size](const void* p) { munmap(const_cast<void*>(p), size); });
+
+        const char* file = static_cast<const char*>(address);
+        Header header;
+        memcpy(&header, file, sizeof(header));
+        if (memcmp(header.magic, Magic, sizeof(header.magic)) != 0)
+            throw std::runtime_error(path + " is not a graph file");
+        if (header.version != FormatVersion)
+            throw std::runtime_error(path + ": unsupported graph file version " + std::to_string(header.version));
+        if (header.byteOrder != ByteOrderMarker)
+            throw std::runtime_error(path + " was written on a host with a different byte order");
+        if (header.numVertices >= uint64_t(INT_MAX))
+            throw std::runtime_error(path + " is corrupt");
+
+        int n = int(header.numVertices);
+        const size_t* offsets = section<size_t>(file, size, header.sections[0], header.numVertices + 1);
+        CSRGraph::ExternalArrays arrays;
+        arrays.offsets = offsets;
+        arrays.targets = section<int>(file, size, header.sections[1], header.numSlots);
+        arrays.weights = section<double>(file, size, header.sections[2], header.numSlots);
+        arrays.numEdges = header.numEdges;
+        if (offsets[0] != 0 || offsets[n] != header.numSlots)
+            throw std::runtime_error(path + " is corrupt");
+        uint64_t edges = 0;
+        for (int u = 0; u < n; ++u) {
+            if (offsets[u] > offsets[u + 1])
+                throw std::runtime_error(path + " is corrupt");
+            for (size_t slot = offsets[u]; slot < offsets[u + 1]; ++slot) {
+                int v = arrays.targets[slot];
+                if (v < 0 || v >= n)
+                    throw std::runtime_error(path + " is corrupt");
+                edges += u <= v;
+            }
+        }
+        if (edges != header.numEdges)
+            throw std::runtime_error(path + " is corrupt");
+
+        StoredForest forest;
+        if (header.hasForest) {
+            forest.present = true;
+            forest.edges = section<WeightedEdge>(file, size, header.sections[3], header.forestEdges);
+            forest.count = header.forestEdges;
+            forest.totalWeight = header.forestWeight;
+            forest.mapping = mapping;
+            for (size_t i = 0; i < forest.count; ++i) {
+                const WeightedEdge& edge = forest.edges[i];
+                if (edge.u < 0 || edge.u >= n || edge.v < 0 || edge.v >= n)
+                    throw std::runtime_error(path + " is corrupt");
+            }
+        }
+        return Loaded{CSRGraph(n, arrays, mapping), forest};
+    }
+
+private:
+    static_assert(sizeof(size_t) == sizeof(uint64_t), "offsets are stored as 64-bit values");
+    static_assert(std::is_trivially_copyable<WeightedEdge>::value, "forest edges are stored as raw bytes");
+
+    static constexpr const char* Magic = "MSTGRAPH";
+    static const uint32_t ByteOrderMarker = 0x01020304;
+    static const uint64_t Alignment = 64;
+
+    static uint64_t align(uint64_t position) {
+        return (position + Alignment - 1) / Alignment * Alignment;
+    }
+
+    template <typename T>
+    static const T* section(const char* file, size_t size, uint64_t offset, uint64_t count) {
+        if (offset % Alignment != 0 || offset > size || count > (size - offset) / sizeof(T))
+            throw std::runtime_error("graph file is corrupt or truncated");
+        return reinterpret_cast<const T*>(file + offset);
+    }
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "EdgeView.cpp"
+
+// Synthetic graph generated for a benchmark or a load test, with 0-based vertex ids
+struct GeneratedGraph {
+    std::string family;
+    int numVertices = 0;
+    std::vector<int> sources;
+    std::vector<int> targets;
+    std::vector<double> weights;
+
+    size_t numEdges() const {
+        return sources.size();
+    }
+
+    EdgeView view() const {
+        return EdgeView{sources.data(), targets.data(), weights.data(), sources.size()};
+    }
+
+    void add(int u, int v, double w) {
+        sources.push_back(u);
+        targets.push_back(v);
+        weights.push_back(w);
+    }
+};
+
+// Reproducible graph families. The same seed gives the same graph on every platform: the
+// generators draw raw 64-bit values from std::mt19937_64 (whose sequence the standard fixes) and
+// scale them by hand instead of going through std:: distributions, which differ between standard
+// libraries. No generator emits self-loops; uniform and RMAT graphs may repeat a vertex pair, as
+// real edge feeds do.
+class GraphGenerator {
+public:
+    enum WeightRange {
+        SmallIntegers,  // 1 .. 1000000, which the compact solvers run as 32-bit integers
+        UnitReals       // [0, 1) with 53 random bits, which need doubles
+    };
+
+    GraphGenerator(uint64_t seed, WeightRange weights = SmallIntegers) : random(seed), weightRange(weights) {}
+
+    // G(n, m): m edges with endpoints drawn uniformly
+    GeneratedGraph uniform(int n, size_t m) {
+        if (n < 2)
+            throw std::invalid_argument("uniform graphs need at least 2 vertices");
+        GeneratedGraph graph = start("uniform", n, m);
+        while (graph.numEdges() < m) {
+            int u = vertex(n), v = vertex(n);
+            if (u != v)
+                graph.add(u, v, weight());
+        }
+        return graph;
+    }
+
+    // rows x cols lattice with 4-neighbour edges: large diameter, every degree at most 4
+    GeneratedGraph grid(int rows, int cols) {
+        GeneratedGraph graph = start("grid", rows * cols, size_t(2) * rows * cols);
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) {
+                int u = r * cols + c;
+                if (c + 1 < cols)
+                    graph.add(u, u + 1, weight());
+                if (r + 1 < rows)
+                    graph.add(u, u + cols, weight());
+            }
+        }
+        return graph;
+    }
+
+    // Recursive-matrix power-law graph on 2^scale vertices (the Graph500 parameters by default):
+    // each edge picks one quadrant of the adjacency matrix per level with probabilities a, b, c and
+    // 1 - a - b - c. Vertex ids are shuffled afterwards so the hubs are not all at low ids.
+    GeneratedGraph rmat(int scale, size_t m, double a = 0.57, double b = 0.19, double c = 0.19) {
+        if (scale < 1 || scale > 30)
+            throw std::invalid_argument("RMAT scale must be in 1 .. 30");
+        int n = 1 << scale;
+        GeneratedGraph graph = start("rmat", n, m);
+        while (graph.numEdges() < m) {
+            int u = 0, v = 0;
+            for (int level = 0; level < scale; ++level) {
+                double p = unit();
+                u = 2 * u + (p >= a + b);
+                v = 2 * v + ((p >= a && p < a + b) || p >= a + b + c);
+            }
+            if (u != v)
+                graph.add(u, v, weight());
+        }
+
+        std::vector<int> label(n);
+        for (int i = 0; i < n; ++i)
+            label[i] = i;
+        for (int i = n - 1; i > 0; --i)
+            std::swap(label[i], label[vertex(i + 1)]);
+        for (size_t e = 0; e < graph.numEdges(); ++e) {
+            graph.sources[e] = label[graph.sources[e]];
+            graph.targets[e] = label[graph.targets[e]];
+        }
+        return graph;
+    }
+
+    // K_n: every pair once, n (n - 1) / 2 edges
+    GeneratedGraph complete(int n) {
+        GeneratedGraph graph = start("complete", n, size_t(n) * (n - 1) / 2);
+        for (int u = 0; u < n; ++u) {
+            for (int v = u + 1; v < n; ++v)
+                graph.add(u, v, weight());
+        }
+        return graph;
+    }
+
+private:
+    std::mt19937_64 random;
+    WeightRange weightRange;
+
+    static GeneratedGraph start(const char* family, int n, size_t m) {
+        GeneratedGraph graph;
+        graph.family = family;
+        graph.numVertices = n;
+        graph.sources.reserve(m);
+        graph.targets.reserve(m);
+        graph.weights.reserve(m);
+        return graph;
+    }
+
+    // Uniform in [0, 1) from the top 53 bits
+    double unit() {
+        return double(random() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Uniform in [0, bound); the multiply-shift range reduction has no modulo bias worth measuring
+    int vertex(int bound) {
+        return int(((random() >> 32) * uint64_t(bound)) >> 32);
+    }
+
+    double weight() {
+        if (weightRange == UnitReals)
+            return unit();
+        return double(1 + ((random() >> 32) * 1000000ull >> 32));
+    }
+};
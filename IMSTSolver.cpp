@@ -1,10 +1,73 @@
+#pragma once
 #include <vector>
 #include <list>
 #include <utility> // for std::pair
+#include "EdgeView.cpp"
+#include "CSRGraph.cpp"
+#include "SolverWorkspace.cpp"
+
+struct WeightedEdge {
+    int u;
+    int v;
+    double weight;
+};
+
+// Caller-owned result buffer. Solvers clear and refill it, so reusing one buffer across solves
+// keeps its capacity and avoids a fresh allocation per MST edge.
+struct MSTResult {
+    std::vector<WeightedEdge> edges;
+    double totalWeight = 0.0;
+
+    void clear() {
+        edges.clear();
+        totalWeight = 0.0;
+    }
+
+    void add(int u, int v, double weight) {
+        edges.push_back({u, v, weight});
+        totalWeight += weight;
+    }
+};
 
 class IMSTSolver {
 public:
-    virtual std::list<std::pair<int, int>> solve(int numVertices, 
-                                                 const std::vector<std::pair<int, std::pair<int, double>>>& edges) = 0;
+    // Zero-copy entry point: reads the edges through the view and writes the minimum spanning
+    // forest (with weights and total weight) into the caller's buffer.
+    virtual void solve(int numVertices, const EdgeView& edges, MSTResult& result) = 0;
+
+    // Solve straight from CSR storage (pending edits must already be compacted).
+    // Edge-centric solvers get the edge list copied out of the adjacency into this thread's
+    // workspace for the length of the solve; adjacency-based ones override this.
+    virtual void solve(const CSRGraph& graph, MSTResult& result) {
+        SolverWorkspace& workspace = SolverWorkspace::local();
+        SolverWorkspace::Scope scope(workspace);
+        size_t count = graph.compactedEdges();
+        int* sources = workspace.array<int>(count);
+        int* targets = workspace.array<int>(count);
+        double* weights = workspace.array<double>(count);
+        graph.copyEdges(sources, targets, weights);
+        solve(graph.numVertices(), EdgeView{sources, targets, weights, count}, result);
+    }
+
+    // Original interface, kept as an adapter over the view-based one
+    std::list<std::pair<int, int>> solve(int numVertices, 
+                                         const std::vector<std::pair<int, std::pair<int, double>>>& edges) {
+        std::vector<int> sources(edges.size()), targets(edges.size());
+        std::vector<double> weights(edges.size());
+        for (size_t i = 0; i < edges.size(); ++i) {
+            sources[i] = edges[i].first;
+            targets[i] = edges[i].second.first;
+            weights[i] = edges[i].second.second;
+        }
+
+        MSTResult result;
+        solve(numVertices, EdgeView{sources.data(), targets.data(), weights.data(), edges.size()}, result);
+
+        std::list<std::pair<int, int>> mstEdges;
+        for (const WeightedEdge& edge : result.edges)
+            mstEdges.push_back({edge.u, edge.v});
+        return mstEdges;
+    }
+
     virtual ~IMSTSolver() = default;
 };
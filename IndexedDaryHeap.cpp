@@ -0,0 +1,129 @@
+#pragma once
+#include <cassert>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+// Min-heap over ids in [0, capacity) with real decrease-key.
+// Keys live next to the ids in the heap array so sift loops never chase a second array,
+// and position[id] tracks each id's slot (-1 = never pushed or already popped).
+// Arity is a compile-time parameter so 2-, 4- and 8-ary layouts can be compared.
+template <int Arity>
+class IndexedDaryHeap {
+    static_assert(Arity >= 2, "Heap arity must be at least 2");
+
+public:
+    // Both arrays live in `memory`, e.g. a solver workspace's arena
+    IndexedDaryHeap(int capacity, std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : heap(memory), position(size_t(capacity), -1, memory) {
+        heap.reserve(capacity);
+    }
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    size_t size() const {
+        return heap.size();
+    }
+
+    bool contains(int id) const {
+        return position[id] != -1;
+    }
+
+    double keyOf(int id) const {
+        return heap[position[id]].key;
+    }
+
+    void push(int id, double key) {
+        assert(!contains(id));
+        heap.push_back({key, id});
+        position[id] = int(heap.size() - 1);
+        siftUp(heap.size() - 1);
+    }
+
+    // Lower the key of an id already in the heap; larger keys are ignored
+    void decreaseKey(int id, double key) {
+        size_t i = position[id];
+        if (key < heap[i].key) {
+            heap[i].key = key;
+            siftUp(i);
+        }
+    }
+
+    // Insert id, or lower its key if it is already queued. Returns true if the heap changed.
+    bool pushOrDecrease(int id, double key) {
+        if (!contains(id)) {
+            push(id, key);
+            return true;
+        }
+        if (key < keyOf(id)) {
+            decreaseKey(id, key);
+            return true;
+        }
+        return false;
+    }
+
+    // Remove and return the id with the smallest key together with that key
+    std::pair<int, double> pop() {
+        Entry top = heap.front();
+        position[top.id] = -1;
+
+        Entry last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            position[last.id] = 0;
+            siftDown(0);
+        }
+        return {top.id, top.key};
+    }
+
+private:
+    struct Entry {
+        double key;
+        int id;
+    };
+
+    std::pmr::vector<Entry> heap;
+    std::pmr::vector<int> position;
+
+    void siftUp(size_t i) {
+        Entry moving = heap[i];
+        while (i > 0) {
+            size_t parent = (i - 1) / Arity;
+            if (!(moving.key < heap[parent].key))
+                break;
+            heap[i] = heap[parent];
+            position[heap[i].id] = int(i);
+            i = parent;
+        }
+        heap[i] = moving;
+        position[moving.id] = int(i);
+    }
+
+    void siftDown(size_t i) {
+        Entry moving = heap[i];
+        size_t n = heap.size();
+        while (true) {
+            size_t first = i * Arity + 1;
+            if (first >= n)
+                break;
+
+            size_t last = first + Arity < n ? first + Arity : n;
+            size_t best = first;
+            for (size_t c = first + 1; c < last; ++c) {
+                if (heap[c].key < heap[best].key)
+                    best = c;
+            }
+            if (!(heap[best].key < moving.key))
+                break;
+
+            heap[i] = heap[best];
+            position[heap[i].id] = int(i);
+            i = best;
+        }
+        heap[i] = moving;
+        position[moving.id] = int(i);
+    }
+};
@@ -0,0 +1,68 @@
+#pragma once
+#include <vector>
+#include <iostream>
+#include <limits>
+#include "IMSTSolver.cpp"
+#include "Cancellation.cpp"
+#include "IndexedDaryHeap.cpp"
+#include "Logger.cpp"
+#include "SolverWorkspace.cpp"
+
+// Prim's algorithm over an indexed d-ary heap: every vertex is queued at most once and its key
+// is lowered in place, so the heap never holds more than V entries and nothing is re-processed.
+// Adjacency is read straight from the graph's CSR arrays instead of per-vertex vectors.
+template <int Arity>
+class IndexedPrimSolver : public IMSTSolver {
+public:
+    using IMSTSolver::solve;
+
+    static const int CancellationInterval = 4096;  // Vertices added between two cancellation points
+
+    void solve(int numVertices, const EdgeView& edges, MSTResult& result) override {
+        result.clear();
+        if (numVertices <= 0)
+            return;
+        solve(CSRGraph(numVertices, edges), result);
+    }
+
+    // Returns a minimum spanning forest: one tree per connected component
+    void solve(const CSRGraph& graph, MSTResult& result) override {
+        result.clear();
+        int numVertices = graph.numVertices();
+        const size_t* offsets = graph.offsetData();
+        const int* targets = graph.targetData();
+        const double* weights = graph.weightData();
+
+        // Scratch comes from this thread's workspace and is reused by the next solve
+        SolverWorkspace& workspace = SolverWorkspace::local();
+        SolverWorkspace::Scope scope(workspace);
+        SolverWorkspace::Vector<bool> inMST = workspace.vector<bool>(numVertices, false);
+        SolverWorkspace::Vector<int> parent = workspace.vector<int>(numVertices, -1);
+        IndexedDaryHeap<Arity> heap(numVertices, workspace.resource());
+
+        int settled = 0;
+        for (int root = 0; root < numVertices; ++root) {
+            if (inMST[root])
+                continue;
+
+            heap.push(root, 0.0);
+            while (!heap.empty()) {
+                std::pair<int, double> top = heap.pop();
+                int u = top.first;
+                inMST[u] = true;
+                if (++settled % CancellationInterval == 0)
+                    cancellationPoint();
+                if (parent[u] != -1)
+                    result.add(parent[u], u, top.second);
+
+                for (size_t i = offsets[u]; i < offsets[u + 1]; ++i) {
+                    int v = targets[i];
+                    if (!inMST[v] && heap.pushOrDecrease(v, weights[i]))
+                        parent[v] = u;
+                }
+            }
+        }
+
+        Logger::debug("Prim's Algorithm (", Arity, "-ary heap) executed");
+    }
+};
@@ -0,0 +1,146 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Cancellation.cpp"
+
+// Asynchronous jobs of the server: a long command submitted as a job answers with its id at once
+// and runs later; clients then poll it, wait for its result or cancel it.
+// A job goes Queued -> Running -> Finished, or to Cancelled from either of the first two.
+// Cancelling a queued job takes effect immediately; a running one is cancelled through its token
+// and stops at its next cancellation point (or finishes anyway if it gets there first).
+// Finished and cancelled jobs keep their result until `retained` newer jobs have ended.
+class JobTable {
+public:
+    typedef std::function<void(std::string)> Reply;
+
+    enum State { Queued, Running, Finished, Cancelled };
+
+    struct Job {
+        uint64_t id;
+        CancellationToken cancellation;  // Checked by the job's work
+        State state = Queued;            // The rest is guarded by the table's mutex
+        std::string result;
+        std::vector<Reply> waiters;
+
+        explicit Job(uint64_t id) : id(id) {}
+    };
+
+    explicit JobTable(size_t retained = 256) : retained(retained), nextId(1) {}
+
+    static const char* stateName(State state) {
+        static const char* names[] = {"queued", "running", "finished", "cancelled"};
+        return names[state];
+    }
+
+    std::shared_ptr<Job> submit() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<Job> job = std::make_shared<Job>(nextId++);
+        jobs[job->id] = job;
+        return job;
+    }
+
+    // Called when the job's work starts; false if it was cancelled while queued and must not run
+    bool start(Job& job) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (job.state != Queued)
+            return false;
+        job.state = Running;
+        return true;
+    }
+
+    // Called when the job's work ends, with its response or, if it stopped at a cancellation
+    // point, with cancelled = true. Every waiter gets the result.
+    void finish(Job& job, std::string result, bool cancelled = false) {
+        std::vector<Reply> waiters;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job.state = cancelled ? Cancelled : Finished;
+            job.result = cancelled ? cancelledResult(job) : std::move(result);
+            waiters.swap(job.waiters);
+            retire(job.id);
+        }
+        for (Reply& waiter : waiters)
+            waiter(job.result);
+    }
+
+    // False for an unknown (or no longer retained) id
+    bool poll(uint64_t id, State& state) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = jobs.find(id);
+        if (it == jobs.end())
+            return false;
+        state = it->second->state;
+        return true;
+    }
+
+    // Hands the job's result to reply: right away if the job has ended, otherwise when it does
+    bool wait(uint64_t id, Reply reply) {
+        std::shared_ptr<Job> job;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = jobs.find(id);
+            if (it == jobs.end())
+                return false;
+            job = it->second;
+            if (job->state == Queued || job->state == Running) {
+                job->waiters.push_back(std::move(reply));
+                return true;
+            }
+        }
+        reply(job->result);  // Immutable once the job has ended
+        return true;
+    }
+
+    // Requests cancellation; state is the job's state before the request
+    bool cancel(uint64_t id, State& state) {
+        std::shared_ptr<Job> job;
+        std::vector<Reply> waiters;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = jobs.find(id);
+            if (it == jobs.end())
+                return false;
+            job = it->second;
+            state = job->state;
+            if (state == Running)
+                job->cancellation.cancel();
+            if (state != Queued)
+                return true;
+            job->cancellation.cancel();
+            job->state = Cancelled;
+            job->result = cancelledResult(*job);
+            waiters.swap(job->waiters);
+            retire(job->id);
+        }
+        for (Reply& waiter : waiters)
+            waiter(job->result);
+        return true;
+    }
+
+private:
+    size_t retained;
+    uint64_t nextId;
+    std::mutex mutex;
+    std::unordered_map<uint64_t, std::shared_ptr<Job>> jobs;
+    std::deque<uint64_t> ended;  // Ids of ended jobs, oldest first
+
+    static std::string cancelledResult(const Job& job) {
+        return "Job " + std::to_string(job.id) + " cancelled\n";
+    }
+
+    // Caller holds the mutex
+    void retire(uint64_t id) {
+        ended.push_back(id);
+        while (ended.size() > retained) {
+            jobs.erase(ended.front());
+            ended.pop_front();
+        }
+    }
+};
@@ -0,0 +1,227 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include "IMSTSolver.cpp"
+#include "Cancellation.cpp"
+#include "ConcurrentUnionFind.cpp"
+#include "Logger.cpp"
+#include "ParallelFor.cpp"
+#include "ParallelSort.cpp"
+#include "SolverWorkspace.cpp"
+
+// Filter-Kruskal: split the edges around a pivot weight, solve the light half first and then
+// drop every heavy edge whose endpoints the light half already connected, before it is ever sorted.
+// Partitioning, filtering and the base-case sort all run in parallel. Edges move back and forth
+// between two arrays taken from the thread's solver workspace, so no level allocates.
+// Edges are held as Index ids and Weight weights: 12 bytes each for 32-bit ids with float or
+// integer weights against 16 with doubles. Unsigned integer weights are sorted with an LSD radix
+// sort instead of comparisons.
+template <typename Index, typename Weight>
+class BasicKruskalSolver : public IMSTSolver {
+public:
+    using IMSTSolver::solve;
+
+    BasicKruskalSolver(unsigned numThreads = defaultSolverThreads(), size_t baseCaseSize = 1 << 15)
+        : numThreads(numThreads), baseCaseSize(baseCaseSize) {}
+
+    void solve(int numVertices, const EdgeView& edges, MSTResult& result) override {
+        solveEdges(numVertices, edges, result);
+    }
+
+    // Writes a minimum spanning forest: one tree per connected component. Every weight must be
+    // exactly representable as a Weight.
+    template <typename SourceIndex, typename SourceWeight>
+    void solveEdges(int numVertices, const BasicEdgeView<SourceIndex, SourceWeight>& edges, MSTResult& result) {
+        result.clear();
+        if (numVertices <= 0)
+            return;
+
+        // All scratch comes from this thread's workspace and is reused by the next solve
+        SolverWorkspace& workspace = SolverWorkspace::local();
+        SolverWorkspace::Scope scope(workspace);
+
+        // The edges plus a scratch array of the same size: partitioning moves edges across
+        KruskalEdge* work = workspace.array<KruskalEdge>(edges.size());
+        KruskalEdge* scratch = workspace.array<KruskalEdge>(edges.size());
+        size_t count = 0;
+        for (size_t i = 0; i < edges.size(); ++i) {
+            SourceIndex u = edges.sources[i];
+            SourceIndex v = edges.targets[i];
+            if (u < 0 || u >= numVertices || v < 0 || v >= numVertices)
+                throw std::out_of_range("Edge endpoint out of range.");
+            if (u != v)
+                work[count++] = {Index(u), Index(v), narrowWeight<Weight>(edges.weights[i])};
+        }
+
+        ConcurrentUnionFind components(numVertices, workspace.resource());
+        size_t* chunkCounts = workspace.array<size_t>(2 * size_t(parallelChunks(count, numThreads)));
+        Run run{components, numVertices - 1, result, chunkCounts};
+        filterKruskal(work, scratch, count, run);
+
+        Logger::debug("Kruskal's Algorithm executed");
+    }
+
+private:
+    struct KruskalEdge {
+        Index u;
+        Index v;
+        Weight weight;
+    };
+
+    // State shared by the recursion of one solve
+    struct Run {
+        ConcurrentUnionFind& components;
+        int treeEdgesLeft;
+        MSTResult& result;
+        size_t* chunkCounts;  // Room for two counters per chunk of a parallel pass
+    };
+
+    unsigned numThreads;
+    size_t baseCaseSize;
+
+    static bool byWeight(const KruskalEdge& a, const KruskalEdge& b) {
+        return a.weight < b.weight;
+    }
+
+    // `scratch` is as long as `edges` and free to overwrite
+    void filterKruskal(KruskalEdge* edges, KruskalEdge* scratch, size_t count, Run& run) {
+        if (count == 0 || run.treeEdgesLeft == 0)
+            return;
+        cancellationPoint();  // Between levels of the recursion
+
+        if (count <= baseCaseSize) {
+            kruskal(edges, scratch, count, run);
+            return;
+        }
+
+        Weight pivot = pickPivot(edges, count);
+        size_t lightCount = partition(edges, scratch, count, pivot, run.chunkCounts);
+        if (lightCount == count) {
+            // Every weight is <= the pivot (e.g. all equal): partitioning cannot make progress
+            kruskal(scratch, edges, count, run);
+            return;
+        }
+
+        // Both halves now live in scratch; the same stretches of edges become their scratch
+        filterKruskal(scratch, edges, lightCount, run);
+
+        size_t heavyCount = filter(scratch + lightCount, count - lightCount, run);
+        filterKruskal(scratch + lightCount, edges + lightCount, heavyCount, run);
+    }
+
+    // Plain Kruskal on a small edge set: sort, then a sequential union-find sweep
+    void kruskal(KruskalEdge* edges, KruskalEdge* scratch, size_t count, Run& run) {
+        if constexpr (std::is_unsigned<Weight>::value)
+            radixSort(edges, scratch, count);
+        else
+            parallelSort(edges, count, numThreads, byWeight, scratch);
+        for (size_t i = 0; i < count && run.treeEdgesLeft > 0; ++i) {
+            const KruskalEdge& edge = edges[i];
+            if (run.components.unite(int(edge.u), int(edge.v))) {
+                run.result.add(int(edge.u), int(edge.v), double(edge.weight));
+                run.treeEdgesLeft--;
+            }
+        }
+    }
+
+    // LSD radix sort on the weight, 11 bits per pass, ping-ponging through scratch. Passes
+    // over digits that every weight shares (the high bits of small weights) are skipped.
+    static void radixSort(KruskalEdge* edges, KruskalEdge* scratch, size_t count) {
+        const int DigitBits = 11;
+        const size_t Buckets = size_t(1) << DigitBits;
+        uint64_t all = ~uint64_t(0), any = 0;  // Bits set in every weight / in some weight
+        for (size_t i = 0; i < count; ++i) {
+            all &= uint64_t(edges[i].weight);
+            any |= uint64_t(edges[i].weight);
+        }
+
+        KruskalEdge* from = edges;
+        KruskalEdge* to = scratch;
+        size_t histogram[Buckets];
+        for (int shift = 0; shift < int(sizeof(Weight) * 8); shift += DigitBits) {
+            if ((((all ^ any) >> shift) & (Buckets - 1)) == 0)
+                continue;  // Same digit everywhere: the pass would not move anything
+            std::fill(histogram, histogram + Buckets, 0);
+            for (size_t i = 0; i < count; ++i)
+                histogram[(uint64_t(from[i].weight) >> shift) & (Buckets - 1)]++;
+            size_t offset = 0;
+            for (size_t b = 0; b < Buckets; ++b) {
+                size_t size = histogram[b];
+                histogram[b] = offset;
+                offset += size;
+            }
+            for (size_t i = 0; i < count; ++i)
+                to[histogram[(uint64_t(from[i].weight) >> shift) & (Buckets - 1)]++] = from[i];
+            std::swap(from, to);
+        }
+        if (from != edges)
+            std::copy(from, from + count, edges);
+    }
+
+    // Median of three sampled weights
+    static Weight pickPivot(const KruskalEdge* edges, size_t count) {
+        Weight a = edges[0].weight;
+        Weight b = edges[count / 2].weight;
+        Weight c = edges[count - 1].weight;
+        return std::max(std::min(a, b), std::min(std::max(a, b), c));
+    }
+
+    // Copy the edges into `out`, light ones (weight <= pivot) first; returns how many are light.
+    // Each chunk partitions its own range in place, then copies both parts to their final offsets.
+    size_t partition(KruskalEdge* edges, KruskalEdge* out, size_t count, Weight pivot, size_t* chunkCounts) {
+        size_t chunks = parallelChunks(count, numThreads);
+        size_t* lights = chunkCounts;
+        size_t* lightStart = chunkCounts + chunks;
+        std::fill(lights, lights + chunks, 0);
+        parallelFor(count, numThreads, [&](size_t begin, size_t end, unsigned chunk) {
+            KruskalEdge* split = std::partition(edges + begin, edges + end,
+                                                [pivot](const KruskalEdge& e) { return e.weight <= pivot; });
+            lights[chunk] = size_t(split - (edges + begin));
+        });
+
+        size_t lightTotal = 0;
+        for (size_t c = 0; c < chunks; ++c) {
+            lightStart[c] = lightTotal;
+            lightTotal += lights[c];
+        }
+
+        // The heavy edges before chunk c are the chunk's start minus the light ones before it
+        parallelFor(count, numThreads, [&](size_t begin, size_t end, unsigned chunk) {
+            KruskalEdge* split = edges + begin + lights[chunk];
+            std::copy(edges + begin, split, out + lightStart[chunk]);
+            std::copy(split, edges + end, out + lightTotal + begin - lightStart[chunk]);
+        });
+        return lightTotal;
+    }
+
+    // Keep only edges whose endpoints are still in different components; returns the new count
+    size_t filter(KruskalEdge* edges, size_t count, Run& run) {
+        size_t chunks = parallelChunks(count, numThreads);
+        size_t chunkSize = (count + chunks - 1) / chunks;
+        size_t* kept = run.chunkCounts;
+        std::fill(kept, kept + chunks, 0);
+        parallelFor(count, numThreads, [&](size_t begin, size_t end, unsigned chunk) {
+            size_t k = 0;
+            for (size_t i = begin; i < end; ++i) {
+                if (run.components.find(edges[i].u) != run.components.find(edges[i].v))
+                    edges[begin + k++] = edges[i];
+            }
+            kept[chunk] = k;
+        });
+
+        size_t total = 0;
+        for (size_t c = 0; c < chunks; ++c) {
+            size_t begin = c * chunkSize;
+            if (kept[c] > 0 && begin != total)
+                std::copy(edges + begin, edges + begin + kept[c], edges + total);
+            total += kept[c];
+        }
+        return total;
+    }
+};
+
+typedef BasicKruskalSolver<int, double> KruskalSolver;
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "ParallelFor.cpp"
+#include "TreeAnalytics.cpp"
+
+// Constant-time tree distances: distance(u, v) = d(u) + d(v) - 2 d(lca(u, v)), where d is the
+// distance from the root.
+// The LCA comes from a sparse table over the DFS preorder (the half-size form of the Euler-tour
+// reduction). Every subtree is a contiguous run of the preorder, so for position(u) < position(v)
+// the shallowest vertex in (position(u), position(v)] is the child of the LCA on the path to v.
+// The table holds O(V log V) vertex ids, and each query is two table lookups.
+class LCAIndex {
+public:
+    LCAIndex(const TreeAnalytics& tree)
+        : n(tree.numVertices()), position(n), parent(n), depth(n), root(n), rootDistance(n) {
+        const std::vector<int>& order = tree.preorder();
+        for (int i = 0; i < n; ++i)
+            position[order[i]] = i;
+        for (int u = 0; u < n; ++u) {
+            parent[u] = tree.parentOf(u);
+            depth[u] = tree.depthOf(u);
+            root[u] = tree.rootOf(u);
+            rootDistance[u] = tree.distanceFromRoot(u);
+        }
+
+        // table[k][i] is the shallowest vertex of order[i .. i + 2^k)
+        table.push_back(order);
+        for (int k = 1; (1 << k) <= n; ++k) {
+            const std::vector<int>& previous = table[k - 1];
+            std::vector<int> level(size_t(n - (1 << k) + 1));
+            for (size_t i = 0; i < level.size(); ++i)
+                level[i] = shallower(previous[i], previous[i + (1 << (k - 1))]);
+            table.push_back(std::move(level));
+        }
+    }
+
+    // Lowest common ancestor, or -1 when u and v are in different trees
+    int lca(int u, int v) const {
+        checkVertex(u);
+        checkVertex(v);
+        return lcaUnchecked(u, v);
+    }
+
+    // Tree distance, or infinity when u and v are in different trees
+    double distance(int u, int v) const {
+        checkVertex(u);
+        checkVertex(v);
+        return distanceUnchecked(u, v);
+    }
+
+    // results[i] = distance(queries[i].first, queries[i].second), answered in parallel
+    void distances(const std::vector<std::pair<int, int>>& queries, std::vector<double>& results,
+                   unsigned numThreads = defaultSolverThreads()) const {
+        for (const auto& query : queries) {
+            checkVertex(query.first);  // Up front, so worker threads never throw
+            checkVertex(query.second);
+        }
+        results.resize(queries.size());
+        parallelFor(queries.size(), numThreads, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i)
+                results[i] = distanceUnchecked(queries[i].first, queries[i].second);
+        }, 1 << 14);
+    }
+
+private:
+    int n;
+    std::vector<int> position;  // Index in the preorder
+    std::vector<int> parent;
+    std::vector<int> depth;
+    std::vector<int> root;
+    std::vector<double> rootDistance;
+    std::vector<std::vector<int>> table;
+
+    void checkVertex(int u) const {
+        if (u < 0 || u >= n)
+            throw std::out_of_range("Vertex out of range.");
+    }
+
+    int shallower(int a, int b) const {
+        return depth[a] <= depth[b] ? a : b;
+    }
+
+    int lcaUnchecked(int u, int v) const {
+        if (root[u] != root[v])
+            return -1;
+        if (u == v)
+            return u;
+        int first = position[u], last = position[v];
+        if (first > last)
+            std::swap(first, last);
+        first++;
+        int k = 31 - __builtin_clz(unsigned(last - first + 1));
+        return parent[shallower(table[k][first], table[k][last - (1 << k) + 1])];
+    }
+
+    double distanceUnchecked(int u, int v) const {
+        int ancestor = lcaUnchecked(u, v);
+        if (ancestor == -1)
+            return std::numeric_limits<double>::infinity();
+        return rootDistance[u] + rootDistance[v] - 2.0 * rootDistance[ancestor];
+    }
+};
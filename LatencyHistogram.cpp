@@ -0,0 +1,127 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Latency histogram in the HDR style: log-linear buckets with a fixed relative precision.
+// Values below 2^SubBucketBits get one bucket each; above that, every power-of-two range is split
+// into 2^(SubBucketBits - 1) equal buckets, so a bucket is never wider than 1/128 of its values
+// (under 0.8% error) and percentiles cost no sorting and no per-sample storage. Values up to 2^44
+// (about 4.9 hours in nanoseconds) are tracked; larger ones are clamped.
+// Recording is a relaxed atomic increment, so any number of threads may record into one
+// histogram; reading while others record sees a consistent-enough snapshot for reporting.
+class LatencyHistogram {
+public:
+    static constexpr int SubBucketBits = 8;
+    static constexpr int MaxValueBits = 44;
+
+    LatencyHistogram() : counts(BucketCount), total(0), sum(0), lowest(UINT64_MAX), highest(0) {}
+
+    LatencyHistogram(const LatencyHistogram& other) : LatencyHistogram() {
+        merge(other);
+    }
+
+    void record(uint64_t value) {
+        value = std::min(value, MaxValue);
+        counts[indexOf(value)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+        uint64_t seen = lowest.load(std::memory_order_relaxed);
+        while (value < seen && !lowest.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+        seen = highest.load(std::memory_order_relaxed);
+        while (value > seen && !highest.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+    }
+
+    // Adds the other histogram's samples to this one
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BucketCount; ++i) {
+            uint64_t count = other.counts[i].load(std::memory_order_relaxed);
+            if (count > 0)
+                counts[i].fetch_add(count, std::memory_order_relaxed);
+        }
+        total.fetch_add(other.count(), std::memory_order_relaxed);
+        sum.fetch_add(other.sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        if (other.count() > 0) {
+            uint64_t seen = lowest.load(std::memory_order_relaxed);
+            while (other.min() < seen && !lowest.compare_exchange_weak(seen, other.min())) {}
+            seen = highest.load(std::memory_order_relaxed);
+            while (other.max() > seen && !highest.compare_exchange_weak(seen, other.max())) {}
+        }
+    }
+
+    uint64_t count() const {
+        return total.load(std::memory_order_relaxed);
+    }
+
+    uint64_t min() const {
+        return count() == 0 ? 0 : lowest.load(std::memory_order_relaxed);
+    }
+
+    uint64_t max() const {
+        return highest.load(std::memory_order_relaxed);
+    }
+
+    double mean() const {
+        uint64_t n = count();
+        return n == 0 ? 0.0 : double(sum.load(std::memory_order_relaxed)) / double(n);
+    }
+
+    uint64_t totalValue() const {
+        return sum.load(std::memory_order_relaxed);
+    }
+
+    // Smallest recorded value v such that percentile% of the samples are <= v, to within the
+    // bucket precision (the bucket's upper edge, capped at the largest value seen)
+    uint64_t percentile(double percentile) const {
+        uint64_t n = count();
+        if (n == 0)
+            return 0;
+        uint64_t rank = uint64_t(percentile / 100.0 * double(n) + 0.5);
+        rank = std::max<uint64_t>(1, std::min(rank, n));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BucketCount; ++i) {
+            seen += counts[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+                return std::min(highestIn(i), max());
+        }
+        return max();
+    }
+
+    // Samples <= value, to within the bucket precision; for cumulative exports (e.g. Prometheus)
+    uint64_t countAtOrBelow(uint64_t value) const {
+        size_t last = indexOf(std::min(value, MaxValue));
+        uint64_t seen = 0;
+        for (size_t i = 0; i <= last; ++i)
+            seen += counts[i].load(std::memory_order_relaxed);
+        return seen;
+    }
+
+private:
+    static constexpr uint64_t SubBucketHalf = uint64_t(1) << (SubBucketBits - 1);
+    static constexpr uint64_t MaxValue = (uint64_t(1) << MaxValueBits) - 1;
+    static constexpr size_t BucketCount = size_t(MaxValueBits - SubBucketBits + 2) * SubBucketHalf;
+
+    std::vector<std::atomic<uint64_t>> counts;
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> lowest;
+    std::atomic<uint64_t> highest;
+
+    // Values below 2^SubBucketBits map to themselves. Above, with e = log2(v) - SubBucketBits + 1,
+    // the top SubBucketBits bits of v (v >> e, in [half, 2 half)) pick the bucket within the range.
+    static size_t indexOf(uint64_t value) {
+        if (value < 2 * SubBucketHalf)
+            return size_t(value);
+        int exponent = 63 - __builtin_clzll(value) - SubBucketBits + 1;
+        return size_t(uint64_t(exponent) * SubBucketHalf + (value >> exponent));
+    }
+
+    static uint64_t highestIn(size_t index) {
+        if (index < 2 * SubBucketHalf)
+            return index;
+        uint64_t exponent = index / SubBucketHalf - 1;
+        uint64_t sub = index - exponent * SubBucketHalf;
+        return ((sub + 1) << exponent) - 1;
+    }
+};
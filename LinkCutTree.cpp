@@ -0,0 +1,177 @@
+#pragma once
+#include <limits>
+#include <vector>
+
+// Link-cut tree (Sleator-Tarjan) over a growable pool of nodes, with path-maximum queries.
+// Every node carries a value; pathMax returns the node with the largest value on the tree path
+// between two nodes. All operations are O(log n) amortized.
+class LinkCutTree {
+public:
+    LinkCutTree(int numNodes = 0) {
+        nodes.reserve(numNodes);
+        for (int i = 0; i < numNodes; ++i)
+            addNode(-std::numeric_limits<double>::infinity());
+    }
+
+    // Append a new isolated node and return its id
+    int addNode(double value) {
+        if (!freeNodes.empty()) {
+            int x = freeNodes.back();
+            freeNodes.pop_back();
+            nodes[x] = Node{{-1, -1}, -1, false, value, x};
+            return x;
+        }
+        nodes.push_back(Node{{-1, -1}, -1, false, value, int(nodes.size())});
+        return int(nodes.size() - 1);
+    }
+
+    // Return an isolated node (already cut from everything) to the pool
+    void releaseNode(int x) {
+        freeNodes.push_back(x);
+    }
+
+    double value(int x) const {
+        return nodes[x].value;
+    }
+
+    void setValue(int x, double value) {
+        access(x);
+        nodes[x].value = value;
+        pull(x);
+    }
+
+    bool connected(int x, int y) {
+        return x == y || findRoot(x) == findRoot(y);
+    }
+
+    // Caller guarantees x and y are in different trees
+    void link(int x, int y) {
+        makeRoot(x);
+        nodes[x].parent = y;
+    }
+
+    // Caller guarantees x and y are adjacent in the represented tree
+    void cut(int x, int y) {
+        makeRoot(x);
+        access(y);
+        // x is now y's left child and has no right child
+        nodes[y].child[0] = -1;
+        nodes[x].parent = -1;
+        pull(y);
+    }
+
+    // Node with the largest value on the path x .. y (both must be connected)
+    int pathMax(int x, int y) {
+        makeRoot(x);
+        access(y);
+        return nodes[y].maxNode;
+    }
+
+private:
+    struct Node {
+        int child[2];
+        int parent;
+        bool reversed;
+        double value;
+        int maxNode;  // Node with the largest value in this splay subtree
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> freeNodes;
+    std::vector<int> pushStack;
+
+    bool isSplayRoot(int x) const {
+        int p = nodes[x].parent;
+        return p == -1 || (nodes[p].child[0] != x && nodes[p].child[1] != x);
+    }
+
+    void push(int x) {
+        if (!nodes[x].reversed)
+            return;
+        std::swap(nodes[x].child[0], nodes[x].child[1]);
+        for (int c : nodes[x].child) {
+            if (c != -1)
+                nodes[c].reversed = !nodes[c].reversed;
+        }
+        nodes[x].reversed = false;
+    }
+
+    void pull(int x) {
+        int best = x;
+        for (int c : nodes[x].child) {
+            if (c != -1 && nodes[nodes[c].maxNode].value > nodes[best].value)
+                best = nodes[c].maxNode;
+        }
+        nodes[x].maxNode = best;
+    }
+
+    void rotate(int x) {
+        int p = nodes[x].parent;
+        int g = nodes[p].parent;
+        int side = nodes[p].child[1] == x ? 1 : 0;
+
+        if (!isSplayRoot(p))
+            nodes[g].child[nodes[g].child[1] == p ? 1 : 0] = x;
+        nodes[x].parent = g;
+
+        int moved = nodes[x].child[1 - side];
+        nodes[p].child[side] = moved;
+        if (moved != -1)
+            nodes[moved].parent = p;
+
+        nodes[x].child[1 - side] = p;
+        nodes[p].parent = x;
+        pull(p);
+        pull(x);
+    }
+
+    void splay(int x) {
+        // Push pending reversals from the splay root down to x first
+        pushStack.clear();
+        for (int y = x;; y = nodes[y].parent) {
+            pushStack.push_back(y);
+            if (isSplayRoot(y))
+                break;
+        }
+        for (auto it = pushStack.rbegin(); it != pushStack.rend(); ++it)
+            push(*it);
+
+        while (!isSplayRoot(x)) {
+            int p = nodes[x].parent;
+            if (!isSplayRoot(p)) {
+                int g = nodes[p].parent;
+                bool zigZig = (nodes[g].child[0] == p) == (nodes[p].child[0] == x);
+                rotate(zigZig ? p : x);
+            }
+            rotate(x);
+        }
+    }
+
+    void access(int x) {
+        int last = -1;
+        for (int y = x; y != -1; y = nodes[y].parent) {
+            splay(y);
+            nodes[y].child[1] = last;
+            pull(y);
+            last = y;
+        }
+        splay(x);
+    }
+
+    void makeRoot(int x) {
+        access(x);
+        nodes[x].reversed = !nodes[x].reversed;
+    }
+
+    int findRoot(int x) {
+        access(x);
+        while (true) {
+            push(x);
+            if (nodes[x].child[0] == -1)
+                break;
+            x = nodes[x].child[0];
+        }
+        splay(x);
+        return x;
+    }
+};
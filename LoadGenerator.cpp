@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <strings.h>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "GraphGenerator.cpp"
+#include "LatencyHistogram.cpp"
+#include "ServerConnection.cpp"
+
+// End-to-end load generator for MSTServer. Each thread holds one persistent connection and sends a
+// random mix of Newedge, Removeedge, Prim and Boruvka, one command at a time.
+//  - Closed loop (default): the next command goes out as soon as the previous response is in, so
+//    throughput is whatever the server sustains with that many clients.
+//  - Open loop (--rate R): commands are scheduled at R per second overall, whether or not the
+//    server keeps up. Latency is measured from the scheduled send time rather than the actual one,
+//    so a stalled server shows up in the percentiles instead of silently lowering the send rate.
+// Latencies go into per-command LatencyHistograms; the report gives throughput and
+// p50/p90/p99/p99.9/max for each command and overall.
+class LoadGenerator {
+public:
+    enum Command { Newedge, Removeedge, Prim, Boruvka, CommandCount };
+
+    struct Options {
+        std::string host = "127.0.0.1";
+        int port = 8080;
+        int connections = 4;
+        double seconds = 10.0;
+        double warmupSeconds = 1.0;  // Sent but not recorded
+        double rate = 0.0;           // Commands per second over all connections; 0 = closed loop
+        unsigned mix[CommandCount] = {40, 20, 20, 20};  // Relative weights
+        int vertices = 10000;        // Commands use vertex ids 1 .. vertices
+        size_t edges = 50000;        // Edges of the initial graph
+        bool keepGraph = false;      // Run against the graph the server already has
+        uint64_t seed = 1;
+    };
+
+    explicit LoadGenerator(const Options& options) : options(options), errors(0) {}
+
+    static const char* name(int command) {
+        static const char* names[] = {"Newedge", "Removeedge", "Prim", "Boruvka"};
+        return names[command];
+    }
+
+    // Loads the initial graph, runs the load and prints the report
+    void run(std::ostream& report) {
+        if (!options.keepGraph)
+            loadGraph();
+
+        std::vector<std::thread> threads;
+        std::vector<std::exception_ptr> failures(size_t(options.connections));
+        auto start = Clock::now() + std::chrono::milliseconds(100);  // Every connection is open by then
+        for (int c = 0; c < options.connections; ++c) {
+            threads.emplace_back([this, c, start, &failures] {
+                try {
+                    client(c, start);
+                } catch (...) {
+                    failures[size_t(c)] = std::current_exception();
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+        for (const std::exception_ptr& failure : failures) {
+            if (failure)
+                std::rethrow_exception(failure);
+        }
+        print(report);
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    Options options;
+    LatencyHistogram latencies[CommandCount];  // Nanoseconds
+    std::atomic<uint64_t> errors;              // "Error: ..." responses
+
+    // A uniform random graph on vertices 1 .. n, sent as one bulk Newgraph
+    void loadGraph() {
+        GraphGenerator generator(options.seed);
+        GeneratedGraph graph = generator.uniform(options.vertices, options.edges);
+        ServerConnection connection(options.host, options.port);
+        connection.send("Newgraph " + std::to_string(options.vertices) + "," + std::to_string(graph.numEdges()) +
+                        ",f64\n");
+        std::vector<char> records(graph.numEdges() * 16);
+        for (size_t e = 0; e < graph.numEdges(); ++e) {
+            uint32_t u = uint32_t(graph.sources[e] + 1), v = uint32_t(graph.targets[e] + 1);
+            memcpy(&records[e * 16], &u, 4);
+            memcpy(&records[e * 16 + 4], &v, 4);
+            memcpy(&records[e * 16 + 8], &graph.weights[e], 8);
+        }
+        connection.send(records.data(), records.size());
+        std::string reply = connection.readLine();
+        if (reply != "Graph created")
+            throw std::runtime_error("Newgraph failed: " + reply);
+    }
+
+    void client(int index, Clock::time_point start) {
+        ServerConnection connection(options.host, options.port);
+        std::mt19937_64 random(options.seed * 7919 + uint64_t(index) + 1);
+        int n = options.vertices;
+        unsigned mixTotal = 0;
+        for (unsigned weight : options.mix)
+            mixTotal += weight;
+        if (mixTotal == 0)
+            throw std::invalid_argument("the command mix is empty");
+
+        // Open loop: this connection's share of the rate, staggered against the other connections
+        double interval = options.rate > 0 ? options.connections / options.rate : 0.0;
+        auto scheduled = start + std::chrono::duration_cast<Clock::duration>(
+                                     std::chrono::duration<double>(interval * index / options.connections));
+        auto recordFrom = start + std::chrono::duration_cast<Clock::duration>(
+                                      std::chrono::duration<double>(options.warmupSeconds));
+        auto end = recordFrom + std::chrono::duration_cast<Clock::duration>(
+                                    std::chrono::duration<double>(options.seconds));
+
+        std::vector<std::pair<int, int>> added;  // Edges this connection inserted, candidates for Removeedge
+        std::this_thread::sleep_until(start);
+        while (true) {
+            auto sendTime = Clock::now();
+            if (interval > 0) {
+                std::this_thread::sleep_until(scheduled);
+                sendTime = scheduled;  // Not the actual send time: a late command counts its wait
+                scheduled += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(interval));
+            }
+            if (sendTime >= end)
+                break;
+
+            int command = pick(random, mixTotal);
+            std::string line;
+            if (command == Newedge) {
+                int u = 1 + int(random() % uint64_t(n)), v = 1 + int(random() % uint64_t(n));
+                line = "Newedge " + std::to_string(u) + "," + std::to_string(v) + "," +
+                       std::to_string(1 + random() % 1000000);
+                added.push_back({u, v});
+            } else if (command == Removeedge) {
+                std::pair<int, int> edge(1 + int(random() % uint64_t(n)), 1 + int(random() % uint64_t(n)));
+                if (!added.empty()) {
+                    size_t k = size_t(random() % added.size());
+                    edge = added[k];
+                    added[k] = added.back();
+                    added.pop_back();
+                }
+                line = "Removeedge " + std::to_string(edge.first) + "," + std::to_string(edge.second);
+            } else {
+                line = name(command);
+            }
+
+            connection.send(line + "\n");
+            if (!readResponse(connection))
+                errors.fetch_add(1, std::memory_order_relaxed);
+            auto received = Clock::now();
+            if (sendTime >= recordFrom) {
+                auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(received - sendTime);
+                latencies[command].record(uint64_t(latency.count()));
+            }
+        }
+    }
+
+    int pick(std::mt19937_64& random, unsigned mixTotal) const {
+        unsigned ticket = unsigned(random() % mixTotal);
+        for (int command = 0; command < CommandCount; ++command) {
+            if (ticket < options.mix[command])
+                return command;
+            ticket -= options.mix[command];
+        }
+        return CommandCount - 1;
+    }
+
+    // Reads one full response; an MST runs until its "Time taken" line. False for an error reply.
+    static bool readResponse(ServerConnection& connection) {
+        std::string line = connection.readLine();
+        if (line == "MST:") {
+            while (line.compare(0, 11, "Time taken:") != 0)
+                line = connection.readLine();
+            return true;
+        }
+        return line.compare(0, 6, "Error:") != 0 && line != "Unknown command";
+    }
+
+    void print(std::ostream& report) const {
+        LatencyHistogram overall;
+        for (const LatencyHistogram& histogram : latencies)
+            overall.merge(histogram);
+
+        if (options.rate > 0)
+            report << "Open loop at " << options.rate << " commands/s";
+        else
+            report << "Closed loop";
+        report << ", " << options.connections << " connections, " << options.seconds << " s" << std::endl;
+        char line[256];
+        snprintf(line, sizeof(line), "%-12s %10s %10s %10s %10s %10s %10s %10s", "command", "count", "ops/s",
+                 "p50 us", "p90 us", "p99 us", "p99.9 us", "max us");
+        report << line << std::endl;
+        for (int command = 0; command <= CommandCount; ++command) {
+            const LatencyHistogram& histogram = command < CommandCount ? latencies[command] : overall;
+            if (histogram.count() == 0)
+                continue;
+            snprintf(line, sizeof(line), "%-12s %10llu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f",
+                     command < CommandCount ? name(command) : "all", (unsigned long long)histogram.count(),
+                     double(histogram.count()) / options.seconds, histogram.percentile(50) / 1e3,
+                     histogram.percentile(90) / 1e3, histogram.percentile(99) / 1e3,
+                     histogram.percentile(99.9) / 1e3, histogram.max() / 1e3);
+            report << line << std::endl;
+        }
+        report << "Errors: " << errors.load() << std::endl;
+    }
+};
+
+// "newedge=40,removeedge=20,prim=20,boruvka=20"; commands left out get weight 0
+static bool parseMix(const std::string& list, unsigned mix[]) {
+    std::fill(mix, mix + LoadGenerator::CommandCount, 0u);
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        size_t equals = item.find('=');
+        if (equals == std::string::npos)
+            return false;
+        std::string command = item.substr(0, equals);
+        int found = -1;
+        for (int c = 0; c < LoadGenerator::CommandCount; ++c) {
+            if (strcasecmp(command.c_str(), LoadGenerator::name(c)) == 0)
+                found = c;
+        }
+        if (found < 0)
+            return false;
+        mix[found] = unsigned(strtoul(item.c_str() + equals + 1, nullptr, 10));
+    }
+    return true;
+}
+
+// Usage: LoadGenerator [--host H] [--port P] [--connections N] [--seconds S] [--warmup S] [--rate R]
+//                      [--mix newedge=40,removeedge=20,prim=20,boruvka=20] [--vertices N]
+//                      [--edges M | --keep-graph] [--seed N]
+int main(int argc, char* argv[]) {
+    LoadGenerator::Options options;
+    bool usage = false;
+    for (int i = 1; i < argc && !usage; ++i) {
+        std::string flag = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (flag == "--host" && hasValue) {
+            options.host = argv[++i];
+        } else if (flag == "--port" && hasValue) {
+            options.port = atoi(argv[++i]);
+        } else if (flag == "--connections" && hasValue) {
+            options.connections = std::max(1, atoi(argv[++i]));
+        } else if (flag == "--seconds" && hasValue) {
+            options.seconds = strtod(argv[++i], nullptr);
+        } else if (flag == "--warmup" && hasValue) {
+            options.warmupSeconds = strtod(argv[++i], nullptr);
+        } else if (flag == "--rate" && hasValue) {
+            options.rate = strtod(argv[++i], nullptr);
+        } else if (flag == "--mix" && hasValue) {
+            usage = !parseMix(argv[++i], options.mix);
+        } else if (flag == "--vertices" && hasValue) {
+            options.vertices = atoi(argv[++i]);
+        } else if (flag == "--edges" && hasValue) {
+            options.edges = strtoull(argv[++i], nullptr, 10);
+        } else if (flag == "--keep-graph") {
+            options.keepGraph = true;
+        } else if (flag == "--seed" && hasValue) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else {
+            usage = true;
+        }
+    }
+    if (usage || options.vertices < 2) {
+        std::cerr << "Usage: " << argv[0] << " [--host H] [--port P] [--connections N] [--seconds S] [--warmup S]"
+                  << " [--rate R] [--mix newedge=40,removeedge=20,prim=20,boruvka=20] [--vertices N]"
+                  << " [--edges M | --keep-graph] [--seed N]" << std::endl;
+        return 1;
+    }
+
+    try {
+        LoadGenerator generator(options);
+        generator.run(std::cout);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,156 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Asynchronous, level-filtered logger.
+// A message below the current level costs one relaxed atomic load, and its arguments are never
+// formatted. An enabled message is formatted by the calling thread and appended to a queue under
+// a short lock; a background thread does the writing, so no worker ever waits on the output
+// stream. If the writer falls behind by more than MaxQueued messages, new ones are dropped and
+// counted rather than blocking the caller.
+class Logger {
+public:
+    enum Level { Debug, Info, Warning, Error, Off };
+
+    static constexpr size_t MaxQueued = 1 << 16;
+
+    static Logger& instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    static void setLevel(Level level) {
+        instance().threshold.store(level, std::memory_order_relaxed);
+    }
+
+    static bool enabled(Level level) {
+        return level >= instance().threshold.load(std::memory_order_relaxed);
+    }
+
+    // "debug", "info", "warning", "error" or "off"; false for anything else
+    static bool parseLevel(const char* name, Level& level) {
+        static const char* names[] = {"debug", "info", "warning", "error", "off"};
+        for (int i = Debug; i <= Off; ++i) {
+            if (strcmp(name, names[i]) == 0) {
+                level = Level(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename... Args>
+    static void debug(const Args&... args) {
+        log(Debug, args...);
+    }
+
+    template <typename... Args>
+    static void info(const Args&... args) {
+        log(Info, args...);
+    }
+
+    template <typename... Args>
+    static void warning(const Args&... args) {
+        log(Warning, args...);
+    }
+
+    template <typename... Args>
+    static void error(const Args&... args) {
+        log(Error, args...);
+    }
+
+    // The arguments are streamed one after another into a single line
+    template <typename... Args>
+    static void log(Level level, const Args&... args) {
+        if (!enabled(level))
+            return;
+        std::ostringstream line;
+        line << prefix(level);
+        (line << ... << args);
+        line << '\n';
+        instance().enqueue(line.str());
+    }
+
+    uint64_t dropped() const {
+        return droppedCount.load(std::memory_order_relaxed);
+    }
+
+    // Blocks until everything queued so far has been written
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        written.wait(lock, [this] { return queue.empty() && !writing; });
+    }
+
+    ~Logger() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wake.notify_one();
+        writer.join();
+    }
+
+private:
+    std::atomic<int> threshold;
+    std::atomic<uint64_t> droppedCount;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable written;
+    std::vector<std::string> queue;
+    bool writing;
+    bool stop;
+    FILE* output;
+    std::thread writer;
+
+    Logger() : threshold(Info), droppedCount(0), writing(false), stop(false), output(stderr) {
+        writer = std::thread([this] { writeLoop(); });
+    }
+
+    static const char* prefix(Level level) {
+        static const char* prefixes[] = {"[debug] ", "[info] ", "[warning] ", "[error] ", ""};
+        return prefixes[level];
+    }
+
+    void enqueue(std::string line) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queue.size() >= MaxQueued) {
+                droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            queue.push_back(std::move(line));
+        }
+        wake.notify_one();
+    }
+
+    // Takes the whole queue at once and writes it outside the lock
+    void writeLoop() {
+        std::vector<std::string> batch;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this] { return stop || !queue.empty(); });
+            if (queue.empty() && stop)
+                return;
+            batch.swap(queue);
+            writing = true;
+            lock.unlock();
+
+            for (const std::string& line : batch)
+                fwrite(line.data(), 1, line.size(), output);
+            fflush(output);
+            batch.clear();
+
+            lock.lock();
+            writing = false;
+            written.notify_all();
+        }
+    }
+};
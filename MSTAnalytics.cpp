@@ -0,0 +1,32 @@
+#pragma once
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include "IMSTSolver.cpp"
+#include "LCAIndex.cpp"
+
+// Metrics and distance index of one revision's minimum spanning forest; immutable once built
+struct MSTAnalytics {
+    TreeAnalytics tree;
+    LCAIndex distances;
+
+    MSTAnalytics(int numVertices, const MSTResult& forest) : tree(numVertices, forest.edges), distances(tree) {}
+
+    // Response line of an analytics command: Weight, Diameter, Avgdist or "Distance u,v".
+    // Throws invalid_argument for a malformed Distance and out_of_range for an unknown vertex.
+    std::string report(const std::string& command) const {
+        if (command.compare(0, 6, "Weight") == 0)
+            return "Total weight: " + std::to_string(tree.totalWeight()) + "\n";
+        if (command.compare(0, 8, "Diameter") == 0)
+            return "Diameter: " + std::to_string(tree.diameter()) + "\n";
+        if (command.compare(0, 7, "Avgdist") == 0)
+            return "Average distance: " + std::to_string(tree.averageDistance()) + "\n";
+
+        int u, v;
+        if (sscanf(command.c_str(), "Distance %d,%d", &u, &v) != 2)
+            throw std::invalid_argument("usage: Distance u,v");
+        double distance = distances.distance(u, v);
+        return "Distance: " + (std::isinf(distance) ? std::string("unreachable") : std::to_string(distance)) + "\n";
+    }
+};
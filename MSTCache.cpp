@@ -0,0 +1,125 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Cache of immutable per-revision results keyed by (graph id, graph revision, kind), where kind
+// is e.g. the algorithm name. Concurrent requests for the same key share one in-flight
+// computation: the first caller runs it, the others wait on its future. Entries for older
+// revisions of a graph are dropped as soon as a newer revision is cached, and the total size is
+// capped by evicting the oldest entry.
+template <typename Value>
+class RevisionCache {
+public:
+    typedef std::shared_ptr<const Value> Response;
+
+    RevisionCache(size_t capacity = 256) : capacity(capacity), hitCount(0), missCount(0), nextTicket(0) {}
+
+    // compute() returns the Value (or something it can be constructed from)
+    template <typename Compute>
+    Response getOrCompute(uint64_t graphId, uint64_t revision, const std::string& algorithm, Compute&& compute) {
+        Key key{graphId, revision, algorithm};
+        std::promise<Response> promise;
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            hitCount.fetch_add(1, std::memory_order_relaxed);
+            std::shared_future<Response> ready = it->second.response;
+            lock.unlock();
+            return ready.get();  // Blocks only while the first request is still computing
+        }
+        missCount.fetch_add(1, std::memory_order_relaxed);
+        uint64_t ticket = insert(key, promise.get_future().share());
+        lock.unlock();
+
+        try {
+            Response response = std::make_shared<const Value>(compute());
+            promise.set_value(response);
+            return response;
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+            std::lock_guard<std::mutex> lock(mutex);
+            // Let the next request retry instead of caching the failure; unless the entry was
+            // evicted meanwhile and the key now belongs to another request's computation
+            auto it = entries.find(key);
+            if (it != entries.end() && it->second.ticket == ticket)
+                erase(key);
+            throw;
+        }
+    }
+
+    uint64_t hits() const {
+        return hitCount.load(std::memory_order_relaxed);
+    }
+
+    uint64_t misses() const {
+        return missCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Key {
+        uint64_t graphId;
+        uint64_t revision;
+        std::string algorithm;
+
+        bool operator==(const Key& other) const {
+            return graphId == other.graphId && revision == other.revision && algorithm == other.algorithm;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            size_t h = std::hash<std::string>()(key.algorithm);
+            h ^= std::hash<uint64_t>()(key.graphId) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            h ^= std::hash<uint64_t>()(key.revision) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            return h;
+        }
+    };
+
+    struct Entry {
+        std::shared_future<Response> response;
+        typename std::list<Key>::iterator age;
+        uint64_t ticket;  // Identifies the computation that created the entry
+    };
+
+    size_t capacity;
+    std::atomic<uint64_t> hitCount;
+    std::atomic<uint64_t> missCount;
+    std::mutex mutex;
+    std::unordered_map<Key, Entry, KeyHash> entries;
+    std::list<Key> insertionOrder;  // Oldest first
+    uint64_t nextTicket;
+
+    uint64_t insert(const Key& key, std::shared_future<Response> response) {
+        // A newer revision makes every older response for the same graph unreachable
+        for (auto it = insertionOrder.begin(); it != insertionOrder.end();) {
+            auto next = std::next(it);
+            if (it->graphId == key.graphId && it->revision < key.revision)
+                erase(*it);
+            it = next;
+        }
+        while (!insertionOrder.empty() && entries.size() >= capacity)
+            erase(insertionOrder.front());
+
+        insertionOrder.push_back(key);
+        entries[key] = Entry{response, std::prev(insertionOrder.end()), ++nextTicket};
+        return nextTicket;
+    }
+
+    void erase(Key key) {
+        auto it = entries.find(key);
+        if (it == entries.end())
+            return;
+        insertionOrder.erase(it->second.age);
+        entries.erase(it);
+    }
+};
+
+// Serialized MST responses, keyed by algorithm
+typedef RevisionCache<std::string> MSTCache;
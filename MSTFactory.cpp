@@ -1,52 +1,65 @@
+#pragma once
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 #include "IMSTSolver.cpp"
 #include "BoruvkaSolver.cpp"
 #include "PrimSolver.cpp"
+#include "KruskalSolver.cpp"
+#include "IndexedPrimSolver.cpp"
 
+// Runs an edge-centric solver in the narrowest instantiation that holds the graph's weights
+// exactly: 32-bit unsigned integers (Kruskal radix-sorts those), floats, or the original doubles.
+// Checking the weights costs one pass over them; the solve then moves 20-25% fewer bytes per edge.
+template <template <typename, typename> class Solver>
+class CompactEdgeSolver : public IMSTSolver {
+public:
+    using IMSTSolver::solve;
+
+    void solve(int numVertices, const EdgeView& edges, MSTResult& result) override {
+        switch (classifyWeights(edges)) {
+        case IntegerWeights:
+            integerWeights.solveEdges(numVertices, edges, result);
+            break;
+        case FloatWeights:
+            floatWeights.solveEdges(numVertices, edges, result);
+            break;
+        default:
+            doubleWeights.solveEdges(numVertices, edges, result);
+            break;
+        }
+    }
+
+private:
+    Solver<uint32_t, uint32_t> integerWeights;
+    Solver<uint32_t, float> floatWeights;
+    Solver<int, double> doubleWeights;
+};
 
 class MSTFactory {
 public:
+    // Every name createSolver() accepts
+    static const std::vector<std::string>& algorithms() {
+        static const std::vector<std::string> names = {"Boruvka", "Prim", "Prim2", "Prim4", "Prim8", "Kruskal"};
+        return names;
+    }
+
     static std::unique_ptr<IMSTSolver> createSolver(const std::string& algorithmType) {
         if (algorithmType == "Boruvka") {
-            return std::make_unique<BoruvkaSolver>();
+            return std::make_unique<CompactEdgeSolver<BasicBoruvkaSolver>>();
         } else if (algorithmType == "Prim") {
             return std::make_unique<PrimSolver>();
+        } else if (algorithmType == "Prim2") {
+            return std::make_unique<IndexedPrimSolver<2>>();
+        } else if (algorithmType == "Prim4") {
+            return std::make_unique<IndexedPrimSolver<4>>();
+        } else if (algorithmType == "Prim8") {
+            return std::make_unique<IndexedPrimSolver<8>>();
+        } else if (algorithmType == "Kruskal") {
+            return std::make_unique<CompactEdgeSolver<BasicKruskalSolver>>();
         } else {
             throw std::invalid_argument("Unknown algorithm type.");
         }
     }
 };
-
-int main() {
-    int numVertices = 5;
-    std::vector<std::pair<int, std::pair<int, double>>> edges = {
-        {0, {1, 10.0}}, {0, {3, 5.0}}, {1, {2, 1.0}}, {3, {4, 2.0}}, {2, {4, 3.0}}
-    };
-    
-    try {
-        // Example: Using Boruvka's algorithm
-        std::unique_ptr<IMSTSolver> solver = MSTFactory::createSolver("Boruvka");
-        std::list<std::pair<int, int>> mst = solver->solve(numVertices, edges);
-        
-        std::cout << "MST Edges (Boruvka):\n";
-        for (const auto& edge : mst) {
-            std::cout << edge.first << " - " << edge.second << "\n";
-        }
-
-        // Example: Using Prim's algorithm
-        solver = MSTFactory::createSolver("Prim");
-        mst = solver->solve(numVertices, edges);
-        
-        std::cout << "MST Edges (Prim):\n";
-        for (const auto& edge : mst) {
-            std::cout << edge.first << " - " << edge.second << "\n";
-        }
-
-    } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-    }
-
-    return 0;
-}
-
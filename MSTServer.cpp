@@ -3,269 +3,813 @@
 #include <list>
 #include <thread>
 #include <mutex>
-#include <condition_variable>
 #include <chrono>
 #include <cstring>
-#include <algorithm>  // Include algorithm for remove_if
-#include <queue>
 #include <memory>
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <cmath>
 #include <arpa/inet.h>
 #include <unistd.h>
-#include "MSTFactory.cpp"  // Include the MST Factory for Boruvka/Prim algorithms
+#include "MSTFactory.cpp"  // Include the MST Factory for Boruvka/Prim/Kruskal algorithms
+#include "DynamicMST.cpp"
+#include "MSTCache.cpp"
+#include "EventLoop.cpp"
+#include "ThreadPool.cpp"
+#include "EdgeRecordParser.cpp"
+#include "GraphFile.cpp"
+#include "JobTable.cpp"
+#include "MSTAnalytics.cpp"
+#include "PartitionedMSTSolver.cpp"
+#include "Logger.cpp"
+#include "Metrics.cpp"
 
 #define PORT 8080
-#define NUM_THREADS 4
 
 using namespace std;
 using namespace std::chrono;
 
-// Task class for representing work that needs to be done by a thread in the thread pool
-class Task {
-public:
-    virtual void execute() = 0;
-    virtual ~Task() {}
+// One immutable revision of the graph. A reader keeps the version it started with alive through
+// its shared_ptr; writers never modify a version once it has been published.
+struct GraphVersion {
+    int n;
+    uint64_t id;
+    uint64_t revision;
+    CSRGraph csr;
+    StoredForest forest;  // Only for a version loaded from a file that carried its MST
+
+    // 1-based indexing. The Graph compacts the delta buffer itself, outside its writer lock.
+    GraphVersion(int n, uint64_t id) : n(n), id(id), revision(0), csr(n + 1, CSRGraph::ManualCompaction) {}
+
+    GraphVersion(int n, uint64_t id, CSRGraph csr, StoredForest forest = StoredForest())
+        : n(n), id(id), revision(0), csr(move(csr)), forest(move(forest)) {
+        this->csr.setCompactThreshold(CSRGraph::ManualCompaction);
+    }
 };
 
-// Graph class representing an undirected graph
+// The server's graph, shared by all tasks, with RCU-style snapshot concurrency.
+// Readers take the current version with one atomic load and never lock. Writers serialize on a
+// mutex, copy the current version, apply their edit to the copy and publish it with an atomic
+// store. Copying is cheap because the CSR copy shares the compacted arrays and the older part of
+// the delta buffer. Once the buffer reaches CompactThreshold, the writer that filled it compacts a
+// snapshot after releasing the lock and publishes the new arrays under the same revision, keeping
+// the edits made meanwhile pending. A version is freed when its last reader drops it, so a long
+// solve does not hold up edge ingestion and ingestion never changes the graph under a running solve.
 class Graph {
 public:
-    Graph(int n) : n(n) {
-        graph.resize(n + 1);  // 1-based indexing
+    // maintainForest keeps an incrementally maintained forest once the first MST has been solved
+    // (or loaded with a graph file), so later MST queries cost O(forest size) instead of a solve.
+    // It takes O(V) memory (see DynamicMST). Off (--no-dynamic-mst, or a coordinator), every MST
+    // is computed by the solver.
+    explicit Graph(bool maintainForest = true) : maintainForest(maintainForest) {}
+
+    // Current version, or nullptr before the first Newgraph
+    shared_ptr<const GraphVersion> snapshot() const {
+        return atomic_load(&current);
     }
 
-    void addEdge(int u, int v, double weight) {
-        graph[u].push_back({v, weight});
-        graph[v].push_back({u, weight}); // Undirected graph
-        edges.push_back({u, {v, weight}});
+    // Replace the graph with an empty one on n vertices
+    void reset(int n) {
+        lock_guard<mutex> lock(writeMutex);
+        publish(make_shared<GraphVersion>(n, nextGraphId()));
+        dynamicMST.reset();
     }
 
-    void removeEdge(int u, int v) {
-        graph[u].remove_if([v](const pair<int, double>& edge) { return edge.first == v; });
-        graph[v].remove_if([u](const pair<int, double>& edge) { return edge.first == u; });
-        edges.erase(remove_if(edges.begin(), edges.end(), [&](const pair<int, pair<int, double>>& edge) {
-            return (edge.first == u && edge.second.first == v) || (edge.first == v && edge.second.first == u);
-        }), edges.end());
+    // Replace the graph with one bulk-built from the given edges; for repeated pairs the last
+    // record wins, as with Newedge. The build runs outside the writer lock.
+    void load(int n, const EdgeView& edges) {
+        shared_ptr<GraphVersion> loaded =
+            make_shared<GraphVersion>(n, nextGraphId(), CSRGraph(n + 1, edges, CSRGraph::LastRecordWins));
+        lock_guard<mutex> lock(writeMutex);
+        publish(loaded);
+        dynamicMST.reset();
     }
 
-    vector<pair<int, pair<int, double>>> getEdges() const {
-        return edges;
+    // Replace the graph with a memory-mapped graph file; queries read the mapped arrays directly
+    void loadFile(const string& path) {
+        GraphFile::Loaded file = GraphFile::load(path);
+        int n = file.graph.numVertices() - 1;  // The file includes the unused vertex slot 0
+        if (n < 0)
+            throw runtime_error(path + " has no vertices");
+        shared_ptr<GraphVersion> loaded =
+            make_shared<GraphVersion>(n, nextGraphId(), move(file.graph), move(file.forest));
+        unique_ptr<DynamicMST> seeded;
+        if (maintainForest && loaded->forest.present) {
+            MSTResult forest;
+            loaded->forest.copyTo(forest);
+            seeded = make_unique<DynamicMST>(n + 1);
+            seeded->build(forest);
+        }
+        lock_guard<mutex> lock(writeMutex);
+        publish(loaded);
+        dynamicMST = move(seeded);
     }
 
-    int getNumVertices() const {
-        return n;
+    // Write the current version to a graph file, with its MST if one is known without solving
+    void saveFile(const string& path) {
+        shared_ptr<const GraphVersion> version = snapshot();
+        if (!version)
+            throw runtime_error("no graph, send Newgraph first");
+        MSTResult forest;
+        bool withForest = knownForest(*version, forest);
+        GraphFile::save(path, version->csr, withForest ? &forest : nullptr);
+    }
+
+    // Inserts the edge, or updates its weight if it already exists
+    void addEdge(int u, int v, double weight) {
+        {
+            lock_guard<mutex> lock(writeMutex);
+            shared_ptr<GraphVersion> next = copyCurrent();
+            next->csr.addEdge(u, v, weight);
+            publish(next);
+            if (dynamicMST)
+                dynamicMST->insertEdge(u, v, weight, next->csr);
+        }
+        compactIfDue();
+    }
+
+    bool removeEdge(int u, int v) {
+        {
+            lock_guard<mutex> lock(writeMutex);
+            shared_ptr<GraphVersion> next = copyCurrent();
+            if (!next->csr.removeEdge(u, v))
+                return false;
+            publish(next);
+            if (dynamicMST)
+                dynamicMST->removeEdge(u, v, next->csr);
+        }
+        compactIfDue();
+        return true;
+    }
+
+    // Minimum spanning forest of the given version.
+    // If reuse is allowed, a forest that is already known is copied out instead of solving: the
+    // one stored in the graph file the version was loaded from, or the maintained forest while
+    // the version is still the newest (briefly, under the writer lock). With maintainForest,
+    // writers keep that forest in step with every edit. Otherwise the solver runs on the snapshot
+    // without any lock, and its result seeds the maintained forest the first time round.
+    void minimumSpanningForest(IMSTSolver& solver, const GraphVersion& version, MSTResult& mst, bool reuse = true) {
+        if (reuse && version.forest.present) {
+            version.forest.copyTo(mst);  // Loaded with the file, nothing to solve
+            return;
+        }
+
+        bool seed;
+        {
+            lock_guard<mutex> lock(writeMutex);
+            if (reuse && dynamicMST && isCurrent(version)) {
+                dynamicMST->collect(mst);
+                return;
+            }
+            seed = !dynamicMST && maintainForest;
+        }
+
+        // Vertex slot 0 is unused and stays isolated. The copy shares the arrays; compacting it
+        // also serves later readers of this revision.
+        CSRGraph compacted = version.csr;
+        if (compacted.hasPendingUpdates()) {
+            compacted.compact();
+            installCompacted(version, compacted);
+        }
+        solver.solve(compacted, mst);
+        if (!seed)
+            return;
+
+        // Built outside the lock; only installed if no edit happened in the meantime
+        unique_ptr<DynamicMST> seeded = make_unique<DynamicMST>(version.n + 1);
+        seeded->build(mst);
+        lock_guard<mutex> lock(writeMutex);
+        if (!dynamicMST && isCurrent(version))
+            dynamicMST = move(seeded);
     }
 
 private:
-    int n;
-    vector<list<pair<int, double>>> graph;
-    vector<pair<int, pair<int, double>>> edges; // To store edges for MST
+    static const size_t CompactThreshold = 4096;
+
+    shared_ptr<const GraphVersion> current;  // Accessed only through atomic_load/atomic_store
+    mutex writeMutex;
+    atomic<bool> compacting{false};  // A writer is compacting the delta buffer
+    bool maintainForest;
+    unique_ptr<DynamicMST> dynamicMST;  // Guarded by writeMutex; matches the current version
+
+    static uint64_t nextGraphId() {
+        static atomic<uint64_t> next(1);
+        return next++;
+    }
+
+    // Caller holds writeMutex
+    shared_ptr<GraphVersion> copyCurrent() const {
+        if (!current)
+            throw runtime_error("no graph, send Newgraph first");
+        shared_ptr<GraphVersion> next = make_shared<GraphVersion>(*current);
+        next->revision++;
+        next->forest = StoredForest();  // Describes the loaded revision only
+        return next;
+    }
+
+    // Called without writeMutex: merges a full delta buffer into new arrays, one writer at a time
+    void compactIfDue() {
+        shared_ptr<const GraphVersion> version = snapshot();
+        if (!version || version->csr.pendingUpdates() < CompactThreshold || compacting.exchange(true))
+            return;
+        try {
+            CSRGraph compacted = version->csr;
+            compacted.compact();
+            installCompacted(*version, compacted);
+        } catch (...) {
+            compacting = false;
+            throw;
+        }
+        compacting = false;
+    }
+
+    // Publishes the current version with the arrays of `compacted`, a compacted copy of `version`.
+    // The edges are the same, so the revision (and everything cached for it) stays valid. Skipped
+    // if the graph was replaced or compacted by someone else first.
+    void installCompacted(const GraphVersion& version, const CSRGraph& compacted) {
+        lock_guard<mutex> lock(writeMutex);
+        if (!current || current->id != version.id)
+            return;
+        shared_ptr<GraphVersion> next = make_shared<GraphVersion>(*current);
+        if (next->csr.rebase(version.csr, compacted))
+            publish(next);
+    }
+
+    bool knownForest(const GraphVersion& version, MSTResult& mst) {
+        if (version.forest.present) {
+            version.forest.copyTo(mst);
+            return true;
+        }
+        lock_guard<mutex> lock(writeMutex);
+        if (dynamicMST && isCurrent(version)) {
+            dynamicMST->collect(mst);
+            return true;
+        }
+        return false;
+    }
+
+    void publish(shared_ptr<const GraphVersion> next) {
+        atomic_store(&current, move(next));
+    }
+
+    bool isCurrent(const GraphVersion& version) const {
+        return current && current->id == version.id && current->revision == version.revision;
+    }
+};
+
+// "Newgraph n,m[,format]": m edge records follow on the same connection, as "u,v,w" text lines
+// (format "text", the default) or as packed binary records ("f32" or "f64" weights)
+struct NewgraphHeader {
+    int n = -1;
+    long long m = 0;
+    char format[8] = "text";
+
+    bool parse(const string& command) {
+        return sscanf(command.c_str(), "Newgraph %d,%lld,%7s", &n, &m, format) >= 1 && n >= 0 && m >= 0;
+    }
+
+    bool recordFormat(EdgeRecordParser::Format& parsed) const {
+        if (strcmp(format, "text") == 0)
+            parsed = EdgeRecordParser::Text;
+        else if (strcmp(format, "f32") == 0)
+            parsed = EdgeRecordParser::Binary32;
+        else if (strcmp(format, "f64") == 0)
+            parsed = EdgeRecordParser::Binary64;
+        else
+            return false;
+        return true;
+    }
 };
 
+// Called by the event loop for every framed command: a bulk Newgraph gets a parser that reads
+// its edge records straight off the connection
+shared_ptr<PayloadReader> newgraphPayload(const string& command) {
+    NewgraphHeader header;
+    EdgeRecordParser::Format format;
+    if (command.compare(0, 8, "Newgraph") != 0 || !header.parse(command) || header.m == 0 || !header.recordFormat(format))
+        return nullptr;
+    return make_shared<EdgeRecordParser>(format, uint64_t(header.m));
+}
+
+// Per-revision results shared by all connections
+struct ServerCaches {
+    MSTCache responses;                     // Serialized MST replies, per algorithm
+    RevisionCache<MSTAnalytics> analytics;  // One entry per revision
+
+    ServerCaches() : analytics(16) {}
+};
+
+// The calling worker's result buffer, reused from one solve to the next so it keeps its capacity
+MSTResult& workerResultBuffer() {
+    thread_local MSTResult buffer;
+    return buffer;
+}
+
+// Coordinator mode (--workers): MSTs are solved by these worker servers instead of in-process.
+// Set once at startup.
+struct SolverSettings {
+    vector<PartitionedMSTSolver::Worker> workers;
+    size_t mergeLimit = size_t(1) << 24;
+};
+
+SolverSettings& solverSettings() {
+    static SolverSettings settings;
+    return settings;
+}
+
+// Directory Savegraph and Loadgraph work in (--data-dir); empty disables both commands. Set once at
+// startup.
+string& dataDirectory() {
+    static string directory;
+    return directory;
+}
+
+// A client-supplied graph file name resolved inside the data directory. Absolute paths and ".."
+// components are rejected, so a client can neither write nor map a file outside it.
+string dataPath(const string& name) {
+    const string& directory = dataDirectory();
+    if (directory.empty())
+        throw runtime_error("graph files are disabled; start the server with --data-dir");
+    if (name[0] == '/')
+        throw invalid_argument("graph file must be a relative path");
+    for (size_t start = 0; start <= name.size();) {
+        size_t end = name.find('/', start);
+        if (end == string::npos)
+            end = name.size();
+        if (name.compare(start, end - start, "..") == 0)
+            throw invalid_argument("graph file must not contain ..");
+        start = end + 1;
+    }
+    return directory + "/" + name;
+}
+
+unique_ptr<IMSTSolver> createSolver(const string& algorithmType) {
+    unique_ptr<IMSTSolver> local = MSTFactory::createSolver(algorithmType);  // Rejects unknown names either way
+    const SolverSettings& settings = solverSettings();
+    if (settings.workers.empty())
+        return local;
+    return make_unique<PartitionedMSTSolver>(settings.workers, algorithmType, settings.mergeLimit);
+}
+
 // Helper function to convert MST result to string
-string convertMSTToString(const list<pair<int, int>>& mstEdges) {
+string convertMSTToString(const MSTResult& mst) {
     string result;
-    for (const auto& edge : mstEdges) {
-        result += to_string(edge.first) + " - " + to_string(edge.second) + "\n";
+    result.reserve(mst.edges.size() * 16);
+    for (const auto& edge : mst.edges) {
+        result += to_string(edge.u) + " - " + to_string(edge.v) + "\n";
     }
+    result += "Total weight: " + to_string(mst.totalWeight) + "\n";
     return result;
 }
 
 // Task class that handles a specific client request (graph operations)
 class GraphTask : public Task {
 public:
-    GraphTask(int clientSocket, Graph* graph, string command) 
-        : clientSocket(clientSocket), graph(graph), command(command) {}
+    typedef function<void(string)> Reply;
+
+    // A task with a job runs the background half of an async solve, on the version pinned when the
+    // job was submitted, and hands its response to the job table instead of the connection
+    GraphTask(Graph& graph, string command, shared_ptr<PayloadReader> payload, ServerCaches& caches, JobTable& jobs,
+              Reply reply, shared_ptr<JobTable::Job> job = nullptr, shared_ptr<const GraphVersion> pinned = nullptr)
+        : graph(graph), command(command), payload(move(payload)), caches(caches), jobs(jobs), reply(reply),
+          job(move(job)), pinned(move(pinned)), created(Metrics::Clock::now()), cancelled(false) {}
+
+    // Tasks are recycled through a pool instead of new/delete per request
+    static GraphTask* create(Graph& graph, string command, shared_ptr<PayloadReader> payload, ServerCaches& caches,
+                             JobTable& jobs, Reply reply, shared_ptr<JobTable::Job> job = nullptr,
+                             shared_ptr<const GraphVersion> pinned = nullptr) {
+        return recycler().acquire(graph, move(command), move(payload), caches, jobs, move(reply), move(job),
+                                  move(pinned));
+    }
+
+    void release() override {
+        recycler().release(this);
+    }
+
+    // Solves, and commands that may have to solve, go to the background lane so they never hold
+    // up edge edits; submitting an async solve is itself cheap
+    static ThreadPool::Lane lane(const string& command) {
+        static const char* heavy[] = {"Forest", "Weight", "Diameter", "Avgdist", "Distance", "Savegraph"};
+        if (isSolve(command))
+            return isAsync(command) ? ThreadPool::Interactive : ThreadPool::Background;
+        for (const char* word : heavy) {
+            if (command.compare(0, strlen(word), word) == 0)
+                return ThreadPool::Background;
+        }
+        return ThreadPool::Interactive;
+    }
 
     void execute() override {
-        // Stage 1: Parse the command
-        if (command.find("Newgraph") == 0) {
-            createGraph();
-        } else if (command.find("Boruvka") == 0 || command.find("Prim") == 0) {
-            calculateMST();
-        } else if (command.find("Newedge") == 0) {
-            addEdge();
-        } else if (command.find("Removeedge") == 0) {
-            removeEdge();
+        Metrics::record(Metrics::QueueWait, Metrics::Clock::now() - created);
+        if (job) {
+            runJob();
+            return;
         }
+        Metrics::count(Metrics::classify(command));
+        run();
 
-        close(clientSocket);  // Close connection after task is completed
+        // The connection stays open: the event loop writes the response and reads the next command.
+        // A Wait on an unfinished job has handed the reply to the job table instead.
+        if (reply)
+            reply(move(response));
     }
 
 private:
-    int clientSocket;
-    Graph* graph;
+    Graph& graph;
     string command;
-
-    void createGraph() {
-        // Parse and create the graph
-        int n, m;
-        sscanf(command.c_str(), "Newgraph %d,%d", &n, &m);
-        delete graph;
-        graph = new Graph(n);
-        send(clientSocket, "Graph created\n", strlen("Graph created\n"), 0);
+    shared_ptr<PayloadReader> payload;  // Edge records of a bulk Newgraph
+    ServerCaches& caches;
+    JobTable& jobs;
+    Reply reply;
+    shared_ptr<JobTable::Job> job;
+    shared_ptr<const GraphVersion> pinned;
+    Metrics::Clock::time_point created;  // When the command was handed over
+    bool cancelled;                      // Stopped at a cancellation point
+    string response;
+
+    static ObjectPool<GraphTask>& recycler() {
+        static ObjectPool<GraphTask> pool;
+        return pool;
     }
 
-    void calculateMST() {
-        // Calculate the MST using Boruvka or Prim
-        string algorithmType = (command.find("Boruvka") == 0) ? "Boruvka" : "Prim";
-        unique_ptr<IMSTSolver> solver = MSTFactory::createSolver(algorithmType);
-        vector<pair<int, pair<int, double>>> edges = graph->getEdges();
+    static bool isSolve(const string& command) {
+        return command.find("Boruvka") == 0 || command.find("Prim") == 0 || command.find("Kruskal") == 0;
+    }
 
-        auto start = high_resolution_clock::now();
-        list<pair<int, int>> mstEdges = solver->solve(graph->getNumVertices(), edges);
-        auto end = high_resolution_clock::now();
-        auto duration = duration_cast<milliseconds>(end - start).count();
+    // "Prim async": the solve word followed by "async"
+    static bool isAsync(const string& command) {
+        size_t space = command.find_first_of(" \t");
+        size_t start = space == string::npos ? string::npos : command.find_first_not_of(" \t", space);
+        return start != string::npos && command.compare(start, string::npos, "async") == 0;
+    }
 
-        string result = "MST:\n" + convertMSTToString(mstEdges);
-        result += "Time taken: " + to_string(duration) + " ms\n";
-        send(clientSocket, result.c_str(), result.size(), 0);
+    void run() {
+        // Stage 1: Parse the command
+        try {
+            if (command.find("Newgraph") == 0) {
+                createGraph();
+            } else if (isSolve(command) && isAsync(command)) {
+                if (requireGraph())
+                    submitJob();
+            } else if (isSolve(command)) {
+                if (requireGraph())
+                    calculateMST();
+            } else if (command.find("Poll") == 0 || command.find("Wait") == 0 || command.find("Cancel") == 0) {
+                manageJob();
+            } else if (command.find("Stats") == 0) {
+                reportStats();
+            } else if (command.find("Forest") == 0) {
+                if (requireGraph())
+                    reportForest();
+            } else if (command.find("Newedge") == 0) {
+                if (requireGraph())
+                    addEdge();
+            } else if (command.find("Removeedge") == 0) {
+                if (requireGraph())
+                    removeEdge();
+            } else if (command.find("Savegraph") == 0) {
+                if (requireGraph())
+                    saveGraph();
+            } else if (command.find("Loadgraph") == 0) {
+                loadGraph();
+            } else if (command.find("Weight") == 0 || command.find("Diameter") == 0 ||
+                       command.find("Avgdist") == 0 || command.find("Distance") == 0) {
+                if (requireGraph())
+                    reportAnalytics();
+            } else {
+                response = "Unknown command\n";
+            }
+        } catch (const OperationCancelled&) {
+            cancelled = true;
+        } catch (const exception& e) {
+            response = string("Error: ") + e.what() + "\n";
+        }
+        if (response.compare(0, 6, "Error:") == 0 || response == "Unknown command\n") {
+            Metrics::add(Metrics::CommandErrors);
+            Logger::debug("\"", command, "\" failed: ", response.substr(0, response.size() - 1));
+        }
     }
 
-    void addEdge() {
-        // Add a new edge
-        int u, v;
-        double weight;
-        sscanf(command.c_str(), "Newedge %d,%d,%lf", &u, &v, &weight);
-        graph->addEdge(u, v, weight);
-        send(clientSocket, "Edge added\n", strlen("Edge added\n"), 0);
+    void runJob() {
+        if (!jobs.start(*job))
+            return;  // Cancelled while it was queued
+        {
+            CancellationScope scope(job->cancellation);
+            run();
+        }
+        jobs.finish(*job, move(response), cancelled);
     }
 
-    void removeEdge() {
-        // Remove an edge
-        int u, v;
-        sscanf(command.c_str(), "Removeedge %d,%d", &u, &v);
-        graph->removeEdge(u, v);
-        send(clientSocket, "Edge removed\n", strlen("Edge removed\n"), 0);
+    // The version this command works on
+    shared_ptr<const GraphVersion> snapshot() {
+        if (pinned)
+            return pinned;
+        Metrics::Timer timer(Metrics::Snapshot);
+        return graph.snapshot();
     }
-};
 
-// Thread pool class (Leader-Follower)
-class ThreadPool {
-public:
-    ThreadPool(size_t numThreads) : stop(false) {
-        for (size_t i = 0; i < numThreads; ++i) {
-            workers.emplace_back([this] {
-                while (true) {
-                    Task* task;
-
-                    {   // Lock the queue and wait for a task
-                        unique_lock<mutex> lock(this->queueMutex);
-                        this->condition.wait(lock, [this] { return this->stop || !this->tasks.empty(); });
-
-                        if (this->stop && this->tasks.empty())
-                            return;
-
-                        task = this->tasks.front();
-                        this->tasks.pop();
-                    }
-
-                    // Execute the task
-                    task->execute();
-                    delete task;  // Clean up after task execution
-                }
-            });
+    bool requireGraph() {
+        if (!graph.snapshot()) {
+            response = "Error: no graph, send Newgraph first\n";
+            return false;
         }
+        return true;
     }
 
-    // Add a new task to the thread pool
-    void enqueue(Task* task) {
-        {
-            unique_lock<mutex> lock(queueMutex);
-            tasks.push(task);
+    void createGraph() {
+        // Parse and create the graph; it replaces the current one for every connection
+        NewgraphHeader header;
+        EdgeRecordParser::Format format;
+        if (!header.parse(command))
+            throw invalid_argument("usage: Newgraph n,m[,text|f32|f64]");
+        if (!header.recordFormat(format))
+            throw invalid_argument(string("unknown edge record format ") + header.format);
+
+        if (!payload) {
+            graph.reset(header.n);
+        } else {
+            // The event loop already parsed the records into arrays sized from m
+            const EdgeRecordParser& records = static_cast<const EdgeRecordParser&>(*payload);
+            if (records.failed())
+                throw runtime_error(records.error());
+            graph.load(header.n, records.edges());
         }
-        condition.notify_one();  // Notify a worker thread
+        response = "Graph created\n";
     }
 
-    // Destructor to join all threads
-    ~ThreadPool() {
-        {
-            unique_lock<mutex> lock(queueMutex);
-            stop = true;
+    void calculateMST() {
+        // Calculate the MST using the algorithm named by the command's first word
+        string algorithmType = command.substr(0, command.find_first_of(" \t\r\n"));
+
+        // Everything below works on this one version, however many edits arrive meanwhile
+        shared_ptr<const GraphVersion> version = snapshot();
+
+        // Unchanged graph: reuse (or wait for) the response already serialized for this revision.
+        // If the solve this joined belonged to a job that got cancelled, it is solved again here.
+        MSTCache::Response cached;
+        while (!cached) {
+            try {
+                cached = solveCached(*version, algorithmType);
+            } catch (const OperationCancelled&) {
+                cancellationPoint();  // Rethrows if it was this task that got cancelled
+            }
         }
-        condition.notify_all();
-        for (thread &worker : workers)
-            worker.join();
+        response = *cached;
     }
 
-private:
-    vector<thread> workers;
-    queue<Task*> tasks;
+    MSTCache::Response solveCached(const GraphVersion& version, const string& algorithmType) {
+        return caches.responses.getOrCompute(version.id, version.revision, algorithmType, [&] {
+            unique_ptr<IMSTSolver> solver = createSolver(algorithmType);
+
+            MSTResult& mst = workerResultBuffer();
+            auto start = steady_clock::now();
+            // The solver runs only if no forest of this revision is known yet
+            graph.minimumSpanningForest(*solver, version, mst);
+            auto end = steady_clock::now();
+            Metrics::record(Metrics::Solve, end - start);
+            char elapsed[32];
+            snprintf(elapsed, sizeof(elapsed), "%.3f", duration<double, milli>(end - start).count());
+
+            Metrics::Timer timer(Metrics::Serialize);
+            string result = "MST:\n" + convertMSTToString(mst);
+            result += "Time taken: " + string(elapsed) + " ms\n";
+            return result;
+        });
+    }
 
-    mutex queueMutex;
-    condition_variable condition;
-    bool stop;
-};
+    // "Prim async" etc.: answers with a job id at once and solves the current version in the
+    // background lane; "Poll id", "Wait id" and "Cancel id" follow the job
+    void submitJob() {
+        ThreadPool* pool = ThreadPool::current();
+        if (!pool)
+            throw runtime_error("async jobs need the thread pool");
+        shared_ptr<JobTable::Job> submitted = jobs.submit();
+        string algorithmType = command.substr(0, command.find_first_of(" \t"));
+        pool->enqueue(create(graph, algorithmType, nullptr, caches, jobs, nullptr, submitted, snapshot()),
+                      ThreadPool::Background);
+        response = "Job " + to_string(submitted->id) + "\n";
+    }
 
-// Server function to handle incoming connections and create tasks
-void serverThread(ThreadPool &pool, Graph* &g) {
-    int server_fd, newSocket;
-    struct sockaddr_in address;
-    int opt = 1;
-    int addrlen = sizeof(address);
+    void manageJob() {
+        string word = command.substr(0, command.find_first_of(" \t"));
+        unsigned long long id;
+        if (sscanf(command.c_str() + word.size(), "%llu", &id) != 1)
+            throw invalid_argument("usage: " + word + " job-id");
+
+        JobTable::State state;
+        if (word == "Wait") {
+            if (!jobs.wait(id, reply))  // Replies now or once the job ends
+                throw runtime_error("no job " + to_string(id));
+            reply = nullptr;
+        } else if (word == "Cancel") {
+            if (!jobs.cancel(id, state))
+                throw runtime_error("no job " + to_string(id));
+            const char* outcome = state == JobTable::Running ? "cancelling"
+                                  : state == JobTable::Finished ? "already finished" : "cancelled";
+            response = "Job " + to_string(id) + " " + outcome + "\n";
+        } else {
+            if (!jobs.poll(id, state))
+                throw runtime_error("no job " + to_string(id));
+            response = "Job " + to_string(id) + " " + JobTable::stateName(state) + "\n";
+        }
+    }
 
-    // Create socket
-    if ((server_fd = socket(AF_INET, SOCK_STREAM, 0)) == 0) {
-        perror("Socket failed");
-        exit(EXIT_FAILURE);
+    // "Forest [algorithm]": the minimum spanning forest with exact weights, as "Forest m" and then m
+    // "u,v,w" lines. This is what a coordinator asks its workers for.
+    void reportForest() {
+        size_t space = command.find_first_of(" \t");
+        size_t start = space == string::npos ? string::npos : command.find_first_not_of(" \t\r\n", space);
+        string algorithmType = "Kruskal";
+        if (start != string::npos)
+            algorithmType = command.substr(start, command.find_first_of(" \t\r\n", start) - start);
+
+        shared_ptr<const GraphVersion> version = snapshot();
+        string kind = "Forest " + algorithmType;
+        MSTCache::Response cached = caches.responses.getOrCompute(version->id, version->revision, kind, [&] {
+            unique_ptr<IMSTSolver> solver = createSolver(algorithmType);
+            MSTResult& mst = workerResultBuffer();
+            {
+                Metrics::Timer timer(Metrics::Solve);
+                graph.minimumSpanningForest(*solver, *version, mst);
+            }
+
+            Metrics::Timer timer(Metrics::Serialize);
+            string result = "Forest " + to_string(mst.edges.size()) + "\n";
+            result.reserve(mst.edges.size() * 40);
+            char line[64];
+            for (const auto& edge : mst.edges) {
+                int length = snprintf(line, sizeof(line), "%d,%d,%.17g\n", edge.u, edge.v, edge.weight);
+                result.append(line, size_t(length));
+            }
+            return result;
+        });
+        response = *cached;
     }
 
-    // Bind socket to port 8080
-    if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR | SO_REUSEPORT, &opt, sizeof(opt))) {
-        perror("setsockopt failed");
-        exit(EXIT_FAILURE);
+    // "Stats": the per-stage histograms and counters of every thread in Prometheus text format,
+    // plus the cache and logger counters, terminated by "# EOF"
+    void reportStats() {
+        Metrics::Totals totals;
+        Metrics::collect(totals);
+        response = Metrics::prometheus(totals);
+
+        response += "# HELP mst_cache_hits_total Requests answered from a per-revision cache.\n"
+                    "# TYPE mst_cache_hits_total counter\n"
+                    "mst_cache_hits_total{cache=\"responses\"} " + to_string(caches.responses.hits()) + "\n"
+                    "mst_cache_hits_total{cache=\"analytics\"} " + to_string(caches.analytics.hits()) + "\n"
+                    "# HELP mst_cache_misses_total Requests that had to compute their result.\n"
+                    "# TYPE mst_cache_misses_total counter\n"
+                    "mst_cache_misses_total{cache=\"responses\"} " + to_string(caches.responses.misses()) + "\n"
+                    "mst_cache_misses_total{cache=\"analytics\"} " + to_string(caches.analytics.misses()) + "\n"
+                    "# HELP mst_log_dropped_total Log messages dropped because the writer fell behind.\n"
+                    "# TYPE mst_log_dropped_total counter\n"
+                    "mst_log_dropped_total " + to_string(Logger::instance().dropped()) + "\n# EOF\n";
     }
 
-    address.sin_family = AF_INET;
-    address.sin_addr.s_addr = INADDR_ANY;
-    address.sin_port = htons(PORT);
+    // Weight, Diameter, Avgdist and "Distance u,v" on the current MST. The tree metrics and the
+    // distance index are built once per revision, from the forest the graph already maintains
+    // (Kruskal solves it only if no MST was asked for since the last edit).
+    void reportAnalytics() {
+        shared_ptr<const GraphVersion> version = snapshot();
+        RevisionCache<MSTAnalytics>::Response analytics =
+            caches.analytics.getOrCompute(version->id, version->revision, "analytics", [&] {
+                unique_ptr<IMSTSolver> solver = createSolver("Kruskal");
+                MSTResult& mst = workerResultBuffer();
+                {
+                    Metrics::Timer timer(Metrics::Solve);
+                    graph.minimumSpanningForest(*solver, *version, mst);
+                }
+                Metrics::Timer timer(Metrics::Analytics);
+                return MSTAnalytics(version->n + 1, mst);
+            });
 
-    if (bind(server_fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
-        perror("Bind failed");
-        exit(EXIT_FAILURE);
+        response = analytics->report(command);
     }
 
-    if (listen(server_fd, 3) < 0) {
-        perror("Listen failed");
-        exit(EXIT_FAILURE);
+    // Everything after the command word, e.g. the file name of "Savegraph graph.bin"
+    string argument() const {
+        size_t space = command.find_first_of(" \t");
+        size_t start = space == string::npos ? string::npos : command.find_first_not_of(" \t", space);
+        if (start == string::npos)
+            throw invalid_argument("usage: " + command.substr(0, space) + " path");
+        return command.substr(start);
     }
 
-    // Accept incoming client connections
-    while (true) {
-        cout << "Waiting for a connection..." << endl;
-        if ((newSocket = accept(server_fd, (struct sockaddr*)&address, (socklen_t*)&addrlen)) < 0) {
-            perror("Accept failed");
-            exit(EXIT_FAILURE);
-        }
+    void saveGraph() {
+        graph.saveFile(dataPath(argument()));
+        response = "Graph saved\n";
+    }
 
-        cout << "Connection accepted" << endl;
+    void loadGraph() {
+        graph.loadFile(dataPath(argument()));
+        response = "Graph loaded\n";
+    }
+
+    void addEdge() {
+        // Add a new edge
+        int u, v;
+        double weight;
+        if (sscanf(command.c_str(), "Newedge %d,%d,%lf", &u, &v, &weight) != 3)
+            throw invalid_argument("usage: Newedge u,v,weight");
+        graph.addEdge(u, v, weight);
+        response = "Edge added\n";
+    }
 
-        // Read command from client
-        char buffer[1024] = {0};
-        read(newSocket, buffer, 1024);
-        string command(buffer);
+    void removeEdge() {
+        // Remove an edge
+        int u, v;
+        if (sscanf(command.c_str(), "Removeedge %d,%d", &u, &v) != 2)
+            throw invalid_argument("usage: Removeedge u,v");
+        response = graph.removeEdge(u, v) ? "Edge removed\n" : "Edge not found\n";
+    }
+};
 
-        // Create a task for the incoming request
-        Task* task = new GraphTask(newSocket, g, command);
+// Server function: runs the epoll event loop and turns every framed command into a task
+void serverThread(ThreadPool &pool, Graph &g, ServerCaches &caches, JobTable &jobs, int port) {
+    EventLoop* loop = nullptr;
+    EventLoop eventLoop(port, [&](uint64_t connectionId, string command, shared_ptr<PayloadReader> payload) {
+        // Create a task for the incoming request; its response goes back through the event loop
+        ThreadPool::Lane lane = GraphTask::lane(command);
+        Task* task = GraphTask::create(g, move(command), move(payload), caches, jobs, [loop, connectionId](string response) {
+            loop->complete(connectionId, move(response));
+        });
 
         // Enqueue the task into the thread pool
-        pool.enqueue(task);
-    }
+        pool.enqueue(task, lane);
+    }, newgraphPayload);
+    loop = &eventLoop;
 
-    close(server_fd);
+    Logger::info("Listening on port ", port);
+    eventLoop.run();
 }
 
-int main() {
-    ThreadPool pool(NUM_THREADS);
-    Graph* g = nullptr;
+// Usage: MSTServer [--threads N] [--pin] [--load graph-file] [--data-dir dir] [--port N] [--no-dynamic-mst]
+//                  [--workers host:port,... [--merge-limit edges]] [--log-level debug|info|warning|error|off]
+// With --workers this server is a coordinator: MSTs are solved by the listed worker servers, which
+// can be ordinary MSTServer processes started with --port on this or other machines. The
+// coordinator still holds the edge list it partitions (it receives the edits), but no maintained
+// forest, so every MST query on a new revision goes to the workers.
+int main(int argc, char* argv[]) {
+    size_t numThreads = thread::hardware_concurrency();
+    int port = PORT;
+    Logger::Level logLevel = Logger::Info;
+    bool pinThreads = false;
+    bool maintainForest = true;
+    const char* graphFile = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            numThreads = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--no-dynamic-mst") == 0) {
+            maintainForest = false;  // Solve every MST query instead of maintaining the forest
+        } else if (strcmp(argv[i], "--pin") == 0) {
+            pinThreads = true;  // Pin worker i to CPU i (mod CPU count)
+        } else if (strcmp(argv[i], "--load") == 0 && i + 1 < argc) {
+            graphFile = argv[++i];  // Serve a graph saved with Savegraph right away
+        } else if (strcmp(argv[i], "--data-dir") == 0 && i + 1 < argc) {
+            dataDirectory() = argv[++i];  // Where clients' Savegraph/Loadgraph file names are resolved
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            try {
+                solverSettings().workers = PartitionedMSTSolver::parseWorkers(argv[++i]);
+            } catch (const exception& e) {
+                cerr << "Error: " << e.what() << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--merge-limit") == 0 && i + 1 < argc) {
+            solverSettings().mergeLimit = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc && Logger::parseLevel(argv[i + 1], logLevel)) {
+            ++i;
+        } else {
+            cerr << "Usage: " << argv[0] << " [--threads N] [--pin] [--load graph-file] [--data-dir dir] [--port N]"
+                 << " [--no-dynamic-mst]"
+                 << " [--workers host:port,... [--merge-limit edges]] [--log-level debug|info|warning|error|off]"
+                 << endl;
+            return 1;
+        }
+    }
+
+    Logger::setLevel(logLevel);
+    ThreadPool pool(numThreads == 0 ? 1 : numThreads, pinThreads);
+    Graph g(maintainForest && solverSettings().workers.empty());  // A coordinator keeps no forest
+    ServerCaches caches;
+    JobTable jobs;
+
+    if (graphFile) {
+        try {
+            g.loadFile(graphFile);
+        } catch (const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+    }
 
     // Launch the server on a separate thread
-    thread server(serverThread, ref(pool), ref(g));
+    thread server(serverThread, ref(pool), ref(g), ref(caches), ref(jobs), port);
 
     // Wait for the server thread to finish
     server.join();
 
-    delete g;
     return 0;
 }
-
-
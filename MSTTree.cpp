@@ -1,27 +1,42 @@
-#include <unordered_map>
+#pragma once
 #include <vector>
-#include <algorithm>
-#include <limits>
-#include <list>
-#include <queue>
+#include <memory>
 #include <iostream>
+#include "TreeAnalytics.cpp"
+#include "LCAIndex.cpp"
 
 
 class MSTTree {
 private:
-    // Adjacency list for the tree
-    std::unordered_map<int, std::list<std::pair<int, double>>> treeAdjList;
+    // Edge list of the tree; the analytics arrays and the distance index are built from it on
+    // the first query that needs them
+    std::vector<WeightedEdge> edges;
     int numVertices;
     double totalWeight;
+    std::unique_ptr<TreeAnalytics> analytics;
+    std::unique_ptr<LCAIndex> distanceIndex;
+
+    const TreeAnalytics& getAnalytics() {
+        if (!analytics)
+            analytics.reset(new TreeAnalytics(numVertices, edges));
+        return *analytics;
+    }
+
+    const LCAIndex& getDistanceIndex() {
+        if (!distanceIndex)
+            distanceIndex.reset(new LCAIndex(getAnalytics()));
+        return *distanceIndex;
+    }
 
 public:
     MSTTree(int numVertices) : numVertices(numVertices), totalWeight(0.0) {}
 
     // Add an edge to the tree
     void addEdge(int u, int v, double w) {
-        treeAdjList[u].push_back(std::make_pair(v, w));
-        treeAdjList[v].push_back(std::make_pair(u, w));  // Since this is undirected MST
+        edges.push_back({u, v, w});  // Since this is undirected MST
         totalWeight += w;
+        analytics.reset();
+        distanceIndex.reset();
     }
 
     // Get total weight of the tree (sum of all edge weights)
@@ -29,105 +44,26 @@ public:
         return totalWeight;
     }
 
-    // Calculate the longest distance between two vertices (using DFS)
+    // Calculate the longest distance between two vertices (the diameter of the tree), in O(V)
     double longestDistanceBetweenTwoVertices() {
-        std::vector<bool> visited(numVertices, false);
-        double maxDistance = 0.0;
-
-        // Start DFS from any node, e.g., vertex 0
-        dfs(0, -1, 0.0, visited, maxDistance);
-        return maxDistance;
-    }
-
-    // Helper DFS function to calculate the longest distance
-    void dfs(int u, int parent, double currentDistance, std::vector<bool>& visited, double& maxDistance) {
-        visited[u] = true;
-        maxDistance = std::max(maxDistance, currentDistance);
-
-        for (const auto& neighbor : treeAdjList[u]) {
-            int v = neighbor.first;
-            double w = neighbor.second;
-
-            if (v != parent && !visited[v]) {
-                dfs(v, u, currentDistance + w, visited, maxDistance);
-            }
-        }
+        return getAnalytics().diameter();
     }
 
-    // Calculate the shortest distance between two vertices (using BFS or DFS on the tree)
+    // Calculate the shortest distance between two vertices (the tree path between them), in O(1)
+    // after an O(V log V) preprocessing on the first call. Infinity if they are not connected.
     double shortestDistanceBetweenTwoVertices(int start, int end) {
-        if (start == end) {
-            return 0.0;  // distance from a vertex to itself is 0
-        }
-        
-        std::vector<bool> visited(numVertices, false);
-        std::vector<double> dist(numVertices, std::numeric_limits<double>::infinity());
-        dist[start] = 0.0;
-
-        // Simple BFS for shortest path in an unweighted graph
-        std::queue<int> q;
-        q.push(start);
-
-        while (!q.empty()) {
-            int u = q.front();
-            q.pop();
-
-            for (const auto& neighbor : treeAdjList[u]) {
-                int v = neighbor.first;
-                double w = neighbor.second;
+        return getDistanceIndex().distance(start, end);
+    }
 
-                if (!visited[v]) {
-                    double newDist = dist[u] + w;
-                    if (newDist < dist[v]) {
-                        dist[v] = newDist;
-                    }
-                    q.push(v);
-                }
-            }
-        }
-        
-        return dist[end];
+    // Shortest distances for many (start, end) pairs at once, answered in parallel
+    std::vector<double> shortestDistancesBetweenVertices(const std::vector<std::pair<int, int>>& queries) {
+        std::vector<double> distances;
+        getDistanceIndex().distances(queries, distances);
+        return distances;
     }
 
-    // Calculate the average distance between all pairs of vertices
+    // Calculate the average distance between all pairs of (connected) vertices, in O(V)
     double averageDistanceBetweenVertices() {
-        double totalDistance = 0.0;
-        int count = 0;
-
-        for (int i = 0; i < numVertices; ++i) {
-            for (int j = i + 1; j < numVertices; ++j) {
-                double dist = shortestDistanceBetweenTwoVertices(i, j);
-                totalDistance += dist;
-                count++;
-            }
-        }
-
-        return count > 0 ? totalDistance / count : 0.0;
+        return getAnalytics().averageDistance();
     }
 };
-
-//example usage
-int main() {
-    MSTTree mstTree(5);  // Create an MST tree with 5 vertices
-
-    // Add edges to the MST
-    mstTree.addEdge(0, 1, 10.0);
-    mstTree.addEdge(0, 3, 5.0);
-    mstTree.addEdge(1, 2, 1.0);
-    mstTree.addEdge(3, 4, 2.0);
-
-    // Get total weight of the MST
-    std::cout << "Total weight of MST: " << mstTree.getTotalWeight() << std::endl;
-
-    // Calculate longest distance between two vertices
-    double longestDistance = mstTree.longestDistanceBetweenTwoVertices();
-    std::cout << "Longest distance between two vertices: " << longestDistance << std::endl;
-
-    // Calculate average distance between all pairs of vertices
-    double avgDistance = mstTree.averageDistanceBetweenVertices();
-    std::cout << "Average distance between vertices: " << avgDistance << std::endl;
-
-    return 0;
-}
-
-
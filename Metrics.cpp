@@ -0,0 +1,195 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "LatencyHistogram.cpp"
+
+// Server instrumentation: a latency histogram per request stage plus event counters.
+// Every thread records into its own slot, created on its first record and kept for the life of
+// the process (the event loop and the pool workers never exit), so recording is a clock read and
+// a few uncontended atomic increments. Reports merge the slots of all threads.
+class Metrics {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    enum Stage {
+        Accept,     // Accepting a connection and registering it with epoll
+        Read,       // Reading a socket and framing commands, bulk edge records included
+        QueueWait,  // From handing a command to the pool until a worker starts it
+        Snapshot,   // Taking the graph version a command works on
+        Solve,      // Computing a forest (on a cache miss)
+        Analytics,  // Building tree metrics and the distance index (on a cache miss)
+        Serialize,  // Formatting a response (on a cache miss)
+        Send,       // Writing responses to a socket
+        StageCount
+    };
+
+    enum Counter { ConnectionsAccepted, BytesRead, BytesWritten, CommandErrors, CounterCount };
+
+    // Command words counted separately; anything else counts as "other"
+    enum Command {
+        Newgraph, Newedge, Removeedge, Boruvka, Prim, Kruskal, Forest, Weight, Diameter, Avgdist, Distance,
+        Savegraph, Loadgraph, Stats, Poll, Wait, Cancel, Other, CommandCount
+    };
+
+    static const char* stageName(int stage) {
+        static const char* names[] = {"accept", "read", "queue_wait", "snapshot", "solve", "analytics", "serialize",
+                                      "send"};
+        return names[stage];
+    }
+
+    static const char* commandName(int command) {
+        static const char* names[] = {"Newgraph", "Newedge", "Removeedge", "Boruvka", "Prim", "Kruskal", "Forest",
+                                      "Weight", "Diameter", "Avgdist", "Distance", "Savegraph", "Loadgraph",
+                                      "Stats", "Poll", "Wait", "Cancel", "other"};
+        return names[command];
+    }
+
+    // The command a line starts with; Prim2/Prim4/Prim8 count as Prim
+    static Command classify(const std::string& line) {
+        for (int command = 0; command < Other; ++command) {
+            const char* name = commandName(command);
+            if (line.compare(0, strlen(name), name) == 0)
+                return Command(command);
+        }
+        return Other;
+    }
+
+    static void record(Stage stage, Clock::duration elapsed) {
+        local().stages[stage].record(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    static void add(Counter counter, uint64_t amount = 1) {
+        local().counters[counter].fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    static void count(Command command) {
+        local().commands[command].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Records the time from construction to destruction under one stage
+    class Timer {
+    public:
+        explicit Timer(Stage stage) : stage(stage), start(Clock::now()) {}
+
+        ~Timer() {
+            record(stage, Clock::now() - start);
+        }
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+    private:
+        Stage stage;
+        Clock::time_point start;
+    };
+
+    // Sums over all threads
+    struct Totals {
+        LatencyHistogram stages[StageCount];
+        uint64_t counters[CounterCount] = {};
+        uint64_t commands[CommandCount] = {};
+    };
+
+    static void collect(Totals& totals) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        for (const std::unique_ptr<Slot>& slot : registry()) {
+            for (int stage = 0; stage < StageCount; ++stage)
+                totals.stages[stage].merge(slot->stages[stage]);
+            for (int counter = 0; counter < CounterCount; ++counter)
+                totals.counters[counter] += slot->counters[counter].load(std::memory_order_relaxed);
+            for (int command = 0; command < CommandCount; ++command)
+                totals.commands[command] += slot->commands[command].load(std::memory_order_relaxed);
+        }
+    }
+
+    // Prometheus text exposition of the totals: a histogram of stage times in seconds (with
+    // p50/p99/p99.9 as separate gauges, from the full-resolution histograms) and the counters
+    static std::string prometheus(const Totals& totals) {
+        static const double bounds[] = {1e-6, 5e-6, 1e-5, 5e-5, 1e-4, 5e-4, 1e-3, 5e-3, 1e-2, 5e-2, 0.1, 0.5, 1, 5, 10};
+        static const double quantiles[] = {0.5, 0.99, 0.999};
+        std::string text;
+        char line[256];
+
+        text += "# HELP mst_stage_seconds Time spent in each request stage.\n# TYPE mst_stage_seconds histogram\n";
+        for (int stage = 0; stage < StageCount; ++stage) {
+            const LatencyHistogram& histogram = totals.stages[stage];
+            for (double bound : bounds) {
+                snprintf(line, sizeof(line), "mst_stage_seconds_bucket{stage=\"%s\",le=\"%g\"} %llu\n",
+                         stageName(stage), bound,
+                         (unsigned long long)histogram.countAtOrBelow(uint64_t(bound * 1e9)));
+                text += line;
+            }
+            snprintf(line, sizeof(line),
+                     "mst_stage_seconds_bucket{stage=\"%s\",le=\"+Inf\"} %llu\n"
+                     "mst_stage_seconds_sum{stage=\"%s\"} %.9f\nmst_stage_seconds_count{stage=\"%s\"} %llu\n",
+                     stageName(stage), (unsigned long long)histogram.count(), stageName(stage),
+                     double(histogram.totalValue()) / 1e9, stageName(stage), (unsigned long long)histogram.count());
+            text += line;
+        }
+
+        text += "# HELP mst_stage_quantile_seconds Stage time percentiles.\n# TYPE mst_stage_quantile_seconds gauge\n";
+        for (int stage = 0; stage < StageCount; ++stage) {
+            for (double quantile : quantiles) {
+                snprintf(line, sizeof(line), "mst_stage_quantile_seconds{stage=\"%s\",quantile=\"%g\"} %.9f\n",
+                         stageName(stage), quantile, double(totals.stages[stage].percentile(quantile * 100)) / 1e9);
+                text += line;
+            }
+        }
+
+        text += "# HELP mst_commands_total Commands executed, by command word.\n# TYPE mst_commands_total counter\n";
+        for (int command = 0; command < CommandCount; ++command) {
+            snprintf(line, sizeof(line), "mst_commands_total{command=\"%s\"} %llu\n", commandName(command),
+                     (unsigned long long)totals.commands[command]);
+            text += line;
+        }
+
+        static const char* counters[][2] = {
+            {"mst_connections_accepted_total", "Connections accepted."},
+            {"mst_read_bytes_total", "Bytes read from clients."},
+            {"mst_written_bytes_total", "Bytes written to clients."},
+            {"mst_command_errors_total", "Commands answered with an error."},
+        };
+        for (int counter = 0; counter < CounterCount; ++counter) {
+            snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s counter\n%s %llu\n", counters[counter][0],
+                     counters[counter][1], counters[counter][0], counters[counter][0],
+                     (unsigned long long)totals.counters[counter]);
+            text += line;
+        }
+        return text;
+    }
+
+private:
+    struct Slot {
+        LatencyHistogram stages[StageCount];
+        std::atomic<uint64_t> counters[CounterCount] = {};
+        std::atomic<uint64_t> commands[CommandCount] = {};
+    };
+
+    static Slot& local() {
+        thread_local Slot* slot = registerSlot();
+        return *slot;
+    }
+
+    static Slot* registerSlot() {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().push_back(std::unique_ptr<Slot>(new Slot()));
+        return registry().back().get();
+    }
+
+    static std::mutex& registryMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::vector<std::unique_ptr<Slot>>& registry() {
+        static std::vector<std::unique_ptr<Slot>> slots;
+        return slots;
+    }
+};
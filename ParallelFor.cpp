@@ -0,0 +1,84 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Scheduler that parallel helpers can run their pieces on instead of spawning threads.
+// A thread pool installs itself as the current executor on its worker threads, so solvers that
+// run inside a pool task fork their subtasks onto that same pool.
+class ParallelExecutor {
+public:
+    virtual unsigned concurrency() const = 0;
+
+    // Run body(i) for every i in [0, count) and return once all of them finished.
+    // The calling thread takes part in the work.
+    virtual void runAll(size_t count, const std::function<void(size_t)>& body) = 0;
+
+    virtual ~ParallelExecutor() = default;
+};
+
+inline ParallelExecutor*& currentParallelExecutor() {
+    thread_local ParallelExecutor* executor = nullptr;
+    return executor;
+}
+
+// Number of worker threads a parallel solver should use when none is requested
+inline unsigned defaultSolverThreads() {
+    if (ParallelExecutor* executor = currentParallelExecutor())
+        return executor->concurrency();
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+// Run body(i) for every i in [0, count) concurrently: on the current executor if there is one,
+// otherwise on freshly spawned threads (index 0 always runs on the calling thread).
+template <typename Fn>
+void parallelInvoke(size_t count, Fn&& body) {
+    if (count == 0)
+        return;
+    if (count == 1) {
+        body(size_t(0));
+        return;
+    }
+
+    if (ParallelExecutor* executor = currentParallelExecutor()) {
+        executor->runAll(count, std::function<void(size_t)>(std::ref(body)));
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(count - 1);
+    for (size_t i = 1; i < count; ++i)
+        threads.emplace_back([&body, i] { body(i); });
+    body(size_t(0));
+
+    for (std::thread& t : threads)
+        t.join();
+}
+
+// Number of chunks parallelFor will use for a given range, so callers can size per-chunk buffers
+inline unsigned parallelChunks(size_t count, unsigned numThreads, size_t minChunk = 4096) {
+    if (count == 0)
+        return 1;
+    size_t chunks = std::min<size_t>(numThreads == 0 ? 1 : numThreads, (count + minChunk - 1) / minChunk);
+    return chunks == 0 ? 1 : unsigned(chunks);
+}
+
+// Split [0, count) into contiguous chunks and run fn(begin, end, chunkIndex) on each chunk.
+// Small ranges (or numThreads <= 1) run inline on the calling thread.
+template <typename Fn>
+void parallelFor(size_t count, unsigned numThreads, Fn&& fn, size_t minChunk = 4096) {
+    if (count == 0)
+        return;
+
+    size_t chunks = parallelChunks(count, numThreads, minChunk);
+    size_t chunkSize = (count + chunks - 1) / chunks;
+    parallelInvoke(chunks, [&](size_t c) {
+        size_t begin = c * chunkSize;
+        size_t end = std::min(count, begin + chunkSize);
+        if (begin < end)
+            fn(begin, end, unsigned(c));
+    });
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+#include "ParallelFor.cpp"
+
+// Sort chunks of the array on separate threads, then merge neighbouring runs pairwise
+// (also in parallel) until a single sorted run is left. Given a scratch buffer as long as the
+// array, merges go through it instead of std::inplace_merge allocating one of its own.
+template <typename T, typename Compare>
+void parallelSort(T* data, size_t count, unsigned numThreads, Compare cmp, T* buffer = nullptr,
+                  size_t minChunk = 16384) {
+    unsigned chunks = parallelChunks(count, numThreads, minChunk);
+    if (chunks <= 1) {
+        std::sort(data, data + count, cmp);
+        return;
+    }
+
+    size_t chunkSize = (count + chunks - 1) / chunks;
+    parallelFor(count, numThreads, [&](size_t begin, size_t end, unsigned) {
+        std::sort(data + begin, data + end, cmp);
+    }, minChunk);
+
+    // Runs are `width` long (the last one may be shorter). Each pass merges runs 2k and 2k + 1
+    // and doubles the width; an odd run out waits for the next pass.
+    for (size_t width = chunkSize; width < count; width *= 2) {
+        size_t runs = (count + width - 1) / width;
+        parallelInvoke(runs / 2, [&](size_t m) {
+            size_t first = 2 * m * width, middle = first + width, last = std::min(count, middle + width);
+            if (buffer) {
+                std::merge(data + first, data + middle, data + middle, data + last, buffer + first, cmp);
+                std::copy(buffer + first, buffer + last, data + first);
+            } else {
+                std::inplace_merge(data + first, data + middle, data + last, cmp);
+            }
+        });
+    }
+}
+
+template <typename T, typename Compare>
+void parallelSort(std::vector<T>& data, unsigned numThreads, Compare cmp, size_t minChunk = 16384) {
+    parallelSort(data.data(), data.size(), numThreads, cmp, static_cast<T*>(nullptr), minChunk);
+}
@@ -0,0 +1,209 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "IMSTSolver.cpp"
+#include "Cancellation.cpp"
+#include "KruskalSolver.cpp"
+#include "ParallelFor.cpp"
+#include "ServerConnection.cpp"
+
+// Minimum spanning forest computed by worker processes: MSTServer instances, on other machines or
+// on 127.0.0.1, reached through the ordinary socket protocol.
+// The edges are split into one partition per worker by their vertex pair. Each worker loads its
+// partition with a bulk "Newgraph n,m,f64" and sends back that partition's minimum spanning
+// forest ("Forest algorithm"). An edge missing from its partition's forest is the heaviest edge on
+// some cycle, so it is not in the global MST either: the union of the partial forests, at most
+// parts * (n - 1) edges, has the same MST as the whole graph. While that union is larger than the
+// merge limit it is partitioned again over half as many workers; then the coordinator finishes it
+// with Kruskal.
+// Repeated vertex pairs land in the same partition in input order, so the worker's
+// last-record-wins load sees the same graph a single process would.
+// A worker holds one graph at a time, so it must serve a single coordinator, and the solves of
+// one coordinator process take turns.
+class PartitionedMSTSolver : public IMSTSolver {
+public:
+    struct Worker {
+        std::string host;
+        int port;
+    };
+
+    // "host:port,host:port,...", with IPv6 addresses in brackets
+    static std::vector<Worker> parseWorkers(const std::string& list) {
+        std::vector<Worker> workers;
+        size_t start = 0;
+        while (start <= list.size()) {
+            size_t end = std::min(list.find(',', start), list.size());
+            std::string item = list.substr(start, end - start);
+            size_t colon = item.rfind(':');
+            char* rest = nullptr;
+            long port = colon == std::string::npos ? 0 : strtol(item.c_str() + colon + 1, &rest, 10);
+            if (colon == 0 || port <= 0 || port > 65535 || *rest != '\0')
+                throw std::invalid_argument("bad worker address \"" + item + "\", expected host:port");
+            std::string host = item.substr(0, colon);
+            if (host.size() > 2 && host.front() == '[' && host.back() == ']')
+                host = host.substr(1, host.size() - 2);  // IPv6 literal
+            workers.push_back({host, int(port)});
+            start = end + 1;
+        }
+        return workers;
+    }
+
+    PartitionedMSTSolver(std::vector<Worker> workers, std::string algorithm = "Kruskal",
+                         size_t mergeLimit = size_t(1) << 24)
+        : workers(std::move(workers)), algorithm(std::move(algorithm)), mergeLimit(mergeLimit) {
+        if (this->workers.empty() || this->workers.size() > MaxWorkers)
+            throw std::invalid_argument("need 1 to " + std::to_string(MaxWorkers) + " workers");
+    }
+
+    using IMSTSolver::solve;
+
+    void solve(int numVertices, const EdgeView& edges, MSTResult& result) override {
+        std::lock_guard<std::mutex> lock(solveMutex());
+        std::vector<int> sources, targets;
+        std::vector<double> weights;
+        EdgeView current = edges;
+        size_t parts = workers.size();
+        while (true) {
+            cancellationPoint();  // Between rounds; a round's worker exchanges always complete
+            std::vector<MSTResult> forests = solveParts(numVertices, current, parts);
+            if (parts == 1) {
+                result.clear();
+                for (const WeightedEdge& edge : forests[0].edges)
+                    result.add(edge.u, edge.v, edge.weight);
+                return;
+            }
+
+            // The union of the partial forests replaces the edge list of this round
+            std::vector<int> nextSources, nextTargets;
+            std::vector<double> nextWeights;
+            for (const MSTResult& forest : forests) {
+                for (const WeightedEdge& edge : forest.edges) {
+                    nextSources.push_back(edge.u);
+                    nextTargets.push_back(edge.v);
+                    nextWeights.push_back(edge.weight);
+                }
+            }
+            sources.swap(nextSources);
+            targets.swap(nextTargets);
+            weights.swap(nextWeights);
+            current = EdgeView{sources.data(), targets.data(), weights.data(), sources.size()};
+            if (current.count <= mergeLimit) {
+                KruskalSolver().solve(numVertices, current, result);
+                return;
+            }
+            parts = (parts + 1) / 2;
+        }
+    }
+
+private:
+    static constexpr size_t MaxWorkers = 256;  // Partition ids are stored as bytes
+    static constexpr size_t RecordBytes = 16;  // u32 source, u32 target, f64 weight
+    static constexpr size_t BatchRecords = 4096;
+
+    std::vector<Worker> workers;
+    std::string algorithm;  // What the workers run on their partitions
+    size_t mergeLimit;      // Largest union of forests the coordinator solves itself
+
+    static std::mutex& solveMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    // Partition of an edge: a hash of its unordered vertex pair, scaled to [0, parts)
+    static uint8_t partOf(int u, int v, size_t parts) {
+        uint64_t low = uint32_t(std::min(u, v)), high = uint32_t(std::max(u, v));
+        uint64_t hash = ((high << 32) | low) * 0x9E3779B97F4A7C15ull;
+        return uint8_t(((hash >> 32) * parts) >> 32);
+    }
+
+    // One forest per partition, from workers[0, parts) in parallel
+    std::vector<MSTResult> solveParts(int numVertices, const EdgeView& edges, size_t parts) {
+        std::vector<uint8_t> part(edges.count);
+        parallelFor(edges.count, defaultSolverThreads(), [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i)
+                part[i] = partOf(edges.sources[i], edges.targets[i], parts);
+        }, 1 << 16);
+        std::vector<uint64_t> counts(parts, 0);
+        for (uint8_t p : part)
+            counts[p]++;
+
+        // Plain threads rather than the solver pool: they spend their time blocked on sockets
+        std::vector<MSTResult> forests(parts);
+        std::vector<std::exception_ptr> errors(parts);
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < parts; ++p) {
+            threads.emplace_back([&, p] {
+                try {
+                    solvePart(workers[p], numVertices, edges, part, uint8_t(p), counts[p], forests[p]);
+                } catch (...) {
+                    errors[p] = std::current_exception();
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+        for (const std::exception_ptr& error : errors) {
+            if (error)
+                std::rethrow_exception(error);
+        }
+        return forests;
+    }
+
+    void solvePart(const Worker& worker, int numVertices, const EdgeView& edges, const std::vector<uint8_t>& part,
+                   uint8_t which, uint64_t count, MSTResult& forest) const {
+        ServerConnection connection(worker.host, worker.port);
+
+        // Vertex ids 0 .. numVertices - 1; a server graph on n vertices accepts ids 0 .. n
+        connection.send("Newgraph " + std::to_string(std::max(numVertices - 1, 0)) + "," + std::to_string(count) +
+                        ",f64\n");
+        std::vector<char> batch(BatchRecords * RecordBytes);
+        size_t batched = 0;
+        for (size_t i = 0; i < edges.count; ++i) {
+            if (part[i] != which)
+                continue;
+            uint32_t u = uint32_t(edges.sources[i]), v = uint32_t(edges.targets[i]);
+            char* record = batch.data() + batched * RecordBytes;
+            memcpy(record, &u, sizeof(u));
+            memcpy(record + 4, &v, sizeof(v));
+            memcpy(record + 8, &edges.weights[i], sizeof(double));
+            if (++batched == BatchRecords) {
+                connection.send(batch.data(), batched * RecordBytes);
+                batched = 0;
+            }
+        }
+        connection.send(batch.data(), batched * RecordBytes);
+        expect(connection, "Graph created");
+
+        // "Forest m" and then m "u,v,w" lines
+        connection.send("Forest " + algorithm + "\n");
+        std::string header = connection.readLine();
+        unsigned long long size;
+        if (sscanf(header.c_str(), "Forest %llu", &size) != 1)
+            throw std::runtime_error(connection.name() + ": " + header);
+        forest.clear();
+        forest.edges.reserve(size);
+        for (unsigned long long k = 0; k < size; ++k) {
+            std::string line = connection.readLine();
+            int u, v;
+            double weight;
+            if (sscanf(line.c_str(), "%d,%d,%lf", &u, &v, &weight) != 3)
+                throw std::runtime_error(connection.name() + ": malformed forest edge \"" + line + "\"");
+            forest.add(u, v, weight);
+        }
+    }
+
+    static void expect(ServerConnection& connection, const std::string& reply) {
+        std::string line = connection.readLine();
+        if (line != reply)
+            throw std::runtime_error(connection.name() + ": " + line);
+    }
+};
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+
+// Consumer for raw bytes that follow a command on the same connection (e.g. the edge records of
+// a bulk "Newgraph n,m"). The event loop feeds it straight from its read buffer until done().
+class PayloadReader {
+public:
+    // Consume a prefix of [data, data + size) and return its length. Everything is consumed
+    // unless the payload ends inside the buffer; the rest belongs to the next command.
+    virtual size_t consume(const char* data, size_t size) = 0;
+
+    virtual bool done() const = 0;
+
+    // The client stopped sending before the payload was complete
+    virtual void endOfInput() {}
+
+    virtual ~PayloadReader() {}
+};
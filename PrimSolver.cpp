@@ -1,57 +1,82 @@
+#pragma once
 #include <queue>
 #include <vector>
 #include <iostream>
 #include "IMSTSolver.cpp"
+#include "Cancellation.cpp"
+#include "Logger.cpp"
+#include "SolverWorkspace.cpp"
 #include <limits>
 
 class PrimSolver : public IMSTSolver {
 public:
-    std::list<std::pair<int, int>> solve(int numVertices, 
-                                         const std::vector<std::pair<int, std::pair<int, double>>>& edges) override {
-        std::list<std::pair<int, int>> mstEdges;
-
-        std::vector<std::vector<std::pair<int, double>>> adjList(numVertices);
-        for (const auto& edge : edges) {
-            int u = edge.first;
-            int v = edge.second.first;
-            double w = edge.second.second;
-            adjList[u].push_back({v, w});
-            adjList[v].push_back({u, w});  // Since Prim’s MST works for undirected graphs
-        }
+    using IMSTSolver::solve;
+
+    static const int CancellationInterval = 4096;  // Vertices added between two cancellation points
+
+    void solve(int numVertices, const EdgeView& edges, MSTResult& result) override {
+        result.clear();
+        if (numVertices <= 0)
+            return;
+        solve(CSRGraph(numVertices, edges), result);  // Since Prim’s MST works for undirected graphs
+    }
+
+    void solve(const CSRGraph& graph, MSTResult& result) override {
+        result.clear();
+        int numVertices = graph.numVertices();
+        const size_t* offsets = graph.offsetData();
+        const int* targets = graph.targetData();
+        const double* weights = graph.weightData();
+
+        // Scratch comes from this thread's workspace and is reused by the next solve
+        SolverWorkspace& workspace = SolverWorkspace::local();
+        SolverWorkspace::Scope scope(workspace);
+        SolverWorkspace::Vector<bool> inMST = workspace.vector<bool>(numVertices, false);
+        SolverWorkspace::Vector<double> key = workspace.vector<double>(numVertices, std::numeric_limits<double>::infinity());
+        SolverWorkspace::Vector<int> parent = workspace.vector<int>(numVertices, -1);
+
+        typedef std::pair<double, int> QueueEntry;
+        std::priority_queue<QueueEntry, SolverWorkspace::Vector<QueueEntry>, std::greater<QueueEntry>> pq(
+            std::greater<QueueEntry>(), workspace.vector<QueueEntry>());
 
-        std::vector<bool> inMST(numVertices, false);
-        std::vector<double> key(numVertices, std::numeric_limits<double>::infinity());
-        std::vector<int> parent(numVertices, -1);
+        // Restart from every vertex not reached yet, so disconnected graphs yield a spanning forest
+        int settled = 0;
+        for (int root = 0; root < numVertices; ++root) {
+            if (inMST[root])
+                continue;
 
-        key[0] = 0;
-        std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, std::greater<std::pair<double, int>>> pq;
-        pq.push({0, 0});
+            key[root] = 0;
+            pq.push({0, root});
 
-        while (!pq.empty()) {
-            int u = pq.top().second;
-            pq.pop();
-            inMST[u] = true;
+            while (!pq.empty()) {
+                int u = pq.top().second;
+                pq.pop();
+                if (inMST[u])
+                    continue;  // Stale entry left behind by a later key improvement
+                inMST[u] = true;
+                if (++settled % CancellationInterval == 0)
+                    cancellationPoint();
 
-            for (const auto& neighbor : adjList[u]) {
-                int v = neighbor.first;
-                double weight = neighbor.second;
+                for (size_t i = offsets[u]; i < offsets[u + 1]; ++i) {
+                    int v = targets[i];
+                    double weight = weights[i];
 
-                if (!inMST[v] && weight < key[v]) {
-                    key[v] = weight;
-                    pq.push({key[v], v});
-                    parent[v] = u;
+                    if (!inMST[v] && weight < key[v]) {
+                        key[v] = weight;
+                        pq.push({key[v], v});
+                        parent[v] = u;
+                    }
                 }
             }
         }
 
         // Collecting the MST edges
-        for (int i = 1; i < numVertices; ++i) {
+        for (int i = 0; i < numVertices; ++i) {
             if (parent[i] != -1) {
-                mstEdges.push_back({parent[i], i});
+                result.add(parent[i], i, key[i]);
             }
         }
 
-        std::cout << "Prim's Algorithm executed\n";
-        return mstEdges;
+        Logger::debug("Prim's Algorithm executed");
     }
 };
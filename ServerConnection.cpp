@@ -0,0 +1,112 @@
+#pragma once
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Blocking client side of the server's line protocol: commands go out newline-terminated (a bulk
+// Newgraph is followed by its raw records) and every response is read back line by line.
+// One connection serves one caller at a time.
+class ServerConnection {
+public:
+    ServerConnection(const std::string& host, int port)
+        : endpoint(host + ":" + std::to_string(port)), fd(-1), start(0), scanned(0) {
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        struct addrinfo* addresses = nullptr;
+        int status = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses);
+        if (status != 0)
+            throw std::runtime_error(endpoint + ": " + gai_strerror(status));
+
+        int error = 0;
+        for (struct addrinfo* address = addresses; address && fd < 0; address = address->ai_next) {
+            fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+            if (fd >= 0 && connect(fd, address->ai_addr, address->ai_addrlen) != 0) {
+                error = errno;
+                close(fd);
+                fd = -1;
+            }
+        }
+        freeaddrinfo(addresses);
+        if (fd < 0)
+            throw std::runtime_error(endpoint + ": " + strerror(error));
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));  // Commands are small
+    }
+
+    ~ServerConnection() {
+        close(fd);
+    }
+
+    ServerConnection(const ServerConnection&) = delete;
+    ServerConnection& operator=(const ServerConnection&) = delete;
+
+    // "host:port", for error messages
+    const std::string& name() const {
+        return endpoint;
+    }
+
+    void send(const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t written = ::send(fd, data, size, MSG_NOSIGNAL);
+            if (written < 0 && errno == EINTR)
+                continue;
+            if (written <= 0)
+                throw std::runtime_error(endpoint + ": send failed: " + strerror(errno));
+            data += written;
+            size -= size_t(written);
+        }
+    }
+
+    void send(const std::string& data) {
+        send(data.data(), data.size());
+    }
+
+    // Next response line without its newline
+    std::string readLine() {
+        while (true) {
+            size_t newline = buffer.find('\n', scanned);
+            if (newline != std::string::npos) {
+                std::string line = buffer.substr(start, newline - start);
+                start = scanned = newline + 1;
+                return line;
+            }
+
+            // Drop the lines already returned before reading more
+            buffer.erase(0, start);
+            start = 0;
+            scanned = buffer.size();
+
+            char chunk[64 * 1024];
+            ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+            if (received < 0 && errno == EINTR)
+                continue;
+            if (received < 0)
+                throw std::runtime_error(endpoint + ": receive failed: " + strerror(errno));
+            if (received == 0)
+                throw std::runtime_error(endpoint + ": connection closed");
+            buffer.append(chunk, size_t(received));
+        }
+    }
+
+    // Send a command whose response is a single line, and return that line
+    std::string command(const std::string& line) {
+        send(line + "\n");
+        return readLine();
+    }
+
+private:
+    std::string endpoint;
+    int fd;
+    std::string buffer;  // Received bytes; lines before start were already returned
+    size_t start;
+    size_t scanned;      // buffer[start, scanned) holds no newline
+};
@@ -0,0 +1,180 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+// Scratch memory that MST solvers reuse from one solve to the next on the same thread.
+// Per-solve arrays (component labels, cheapest edges, keys, heaps, edge copies) come from a
+// monotonic arena: allocating is a pointer bump, nothing is freed individually, and the whole
+// arena is rewound in one step when the solve ends. A solve that outgrows the arena takes extra
+// blocks from the heap; afterwards the arena is regrown to that solve's high-water mark, so once
+// the workload's largest solve has been seen, solves no longer touch the heap at all.
+// The arena is not thread-safe: parallel phases write into arrays the owning thread allocated.
+class SolverWorkspace {
+public:
+    template <typename T>
+    using Vector = std::pmr::vector<T>;
+
+    struct Counters {
+        uint64_t solves = 0;            // Outermost scopes that have ended
+        uint64_t arenaAllocations = 0;  // Requests served by the arena
+        uint64_t arenaBytes = 0;
+        uint64_t heapAllocations = 0;   // Blocks taken from the heap: arena growth and overflow
+        uint64_t heapBytes = 0;
+        size_t capacity = 0;            // Current arena size in bytes
+        size_t highWater = 0;           // Most bytes a single solve has used
+    };
+
+    explicit SolverWorkspace(size_t initialCapacity = 64 * 1024)
+        : heap(*this), front(*this), buffer(nullptr), depth(0), used(0), overflow(0) {
+        grow(initialCapacity);
+    }
+
+    ~SolverWorkspace() {
+        arena.reset();
+        heap.deallocate(buffer, stats.capacity, alignof(std::max_align_t));
+    }
+
+    SolverWorkspace(const SolverWorkspace&) = delete;
+    SolverWorkspace& operator=(const SolverWorkspace&) = delete;
+
+    // The calling thread's workspace; every pool worker has its own
+    static SolverWorkspace& local() {
+        thread_local SolverWorkspace workspace;
+        return workspace;
+    }
+
+    // Brackets one solve. Memory handed out inside stays valid until the outermost scope ends,
+    // so a solver may call another one (e.g. after building a CSR view) within the same solve.
+    class Scope {
+    public:
+        explicit Scope(SolverWorkspace& workspace) : workspace(workspace) {
+            workspace.depth++;
+        }
+
+        ~Scope() {
+            if (--workspace.depth == 0)
+                workspace.rewind();
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        SolverWorkspace& workspace;
+    };
+
+    std::pmr::memory_resource* resource() {
+        return &front;
+    }
+
+    template <typename T>
+    Vector<T> vector() {
+        return Vector<T>(resource());
+    }
+
+    template <typename T>
+    Vector<T> vector(size_t count) {
+        return Vector<T>(count, resource());
+    }
+
+    template <typename T>
+    Vector<T> vector(size_t count, const T& value) {
+        return Vector<T>(count, value, resource());
+    }
+
+    // Uninitialized array for trivial element types
+    template <typename T>
+    T* array(size_t count) {
+        return static_cast<T*>(front.allocate(count * sizeof(T), alignof(T)));
+    }
+
+    const Counters& counters() const {
+        return stats;
+    }
+
+private:
+    // Heap side of the arena; every block it hands out is counted
+    class HeapResource : public std::pmr::memory_resource {
+    public:
+        explicit HeapResource(SolverWorkspace& owner) : owner(owner) {}
+
+    private:
+        SolverWorkspace& owner;
+
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            void* p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            owner.stats.heapAllocations++;
+            owner.stats.heapBytes += bytes;
+            if (owner.depth > 0)
+                owner.overflow += bytes;
+            return p;
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    // What solvers allocate from: counts the requests and forwards them to the arena
+    class FrontResource : public std::pmr::memory_resource {
+    public:
+        explicit FrontResource(SolverWorkspace& owner) : owner(owner) {}
+
+    private:
+        SolverWorkspace& owner;
+
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            void* p = owner.arena->allocate(bytes, alignment);
+            owner.stats.arenaAllocations++;
+            owner.stats.arenaBytes += bytes;
+            owner.used += bytes;
+            return p;
+        }
+
+        void do_deallocate(void*, size_t, size_t) override {}  // Reclaimed when the solve ends
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    HeapResource heap;
+    FrontResource front;
+    char* buffer;
+    std::optional<std::pmr::monotonic_buffer_resource> arena;
+    Counters stats;
+    int depth;
+    size_t used;      // Bytes requested during the current solve
+    size_t overflow;  // Bytes the current solve had to take from the heap
+
+    void grow(size_t capacity) {
+        arena.reset();  // Hands any overflow blocks back to the heap
+        if (buffer)
+            heap.deallocate(buffer, stats.capacity, alignof(std::max_align_t));
+        buffer = static_cast<char*>(heap.allocate(capacity, alignof(std::max_align_t)));
+        stats.capacity = capacity;
+        arena.emplace(buffer, capacity, &heap);
+    }
+
+    void rewind() {
+        stats.solves++;
+        stats.highWater = std::max(stats.highWater, used);
+        if (overflow > 0) {
+            // Alignment padding and block headers mean used can undercount the real footprint
+            size_t target = std::max(stats.capacity + overflow, used + used / 8);
+            grow(target);
+        } else {
+            arena->release();  // Back to the start of the buffer; nothing is freed
+        }
+        used = 0;
+        overflow = 0;
+    }
+};
@@ -1,7 +1,31 @@
 #include <iostream>
 #include <cassert>
+#include <cstddef>
 #include <algorithm>  // Include the algorithm header for std::find
+#include <fstream>
+#include <map>
+#include <random>
+#include <thread>
+#include <sys/ioctl.h>
 #include "Graph.cpp"  // Include your Graph implementation
+#include "BoruvkaSolver.cpp"
+#include "KruskalSolver.cpp"
+#include "IndexedDaryHeap.cpp"
+#include "EdgeRecordParser.cpp"
+#include "GraphFile.cpp"
+#include "TreeAnalytics.cpp"
+#include "LCAIndex.cpp"
+#include "MSTAnalytics.cpp"
+#include "DynamicMST.cpp"
+#include "ExternalMSTSolver.cpp"
+#include "PartitionedMSTSolver.cpp"
+#include "GraphGenerator.cpp"
+#include "LatencyHistogram.cpp"
+#include "Metrics.cpp"
+#include "JobTable.cpp"
+#include "MSTCache.cpp"
+#include "EventLoop.cpp"
+#include "ThreadPool.cpp"
 
 void testGraphCreation() {
     Graph g(5);  // Create a graph with 5 vertices
@@ -119,6 +143,1087 @@ void testNonExistentVertex() {
     std::cout << "testNonExistentVertex passed!" << std::endl;
 }
 
+void testEdgeIndexChurn() {
+    Graph g(5);
+    g.removeEdge(0, 1);  // Nothing to remove: the count stays put
+    assert(g.getNumEdges() == 0);
+
+    // A hub vertex with many neighbors; removals move the last neighbor into the gap
+    Graph hub(2000);
+    for (int v = 1; v < 2000; ++v)
+        hub.addEdge(0, v, double(v));
+    for (int v = 1; v < 2000; v += 2)
+        assert(hub.removeEdge(0, v));
+    assert(!hub.removeEdge(0, 1) && hub.getNumEdges() == 999);
+    assert(hub.getNeighbors(0).size() == 999);
+    for (const auto& neighbor : hub.getNeighbors(0))
+        assert(neighbor.first % 2 == 0 && neighbor.second == double(neighbor.first));
+    double w;
+    hub.addEdge(0, 998, 0.5);
+    assert(hub.getWeight(0, 998, w) && w == 0.5 && !hub.getWeight(0, 999, w) && !hub.getWeight(998, 0, w));
+
+    // Random churn against a std::map; the table grows and shifts entries back on erase
+    EdgeIndex index;
+    std::map<std::pair<int, int>, size_t> reference;
+    std::mt19937 random(5);
+    for (int step = 0; step < 200000; ++step) {
+        int u = int(random() % 64), v = int(random() % 64);
+        if (random() % 3 == 0) {
+            assert(index.erase(u, v) == (reference.erase({u, v}) == 1));
+        } else {
+            index.set(u, v, size_t(step));
+            reference[{u, v}] = size_t(step);
+        }
+    }
+    assert(index.size() == reference.size());
+    for (int u = 0; u < 64; ++u) {
+        for (int v = 0; v < 64; ++v) {
+            auto it = reference.find({u, v});
+            assert(index.find(u, v) == (it == reference.end() ? EdgeIndex::NotFound : it->second));
+        }
+    }
+    std::cout << "testEdgeIndexChurn passed!" << std::endl;
+}
+
+void testBoruvkaDisconnectedForest() {
+    // Two components: {0, 1, 2} and {3, 4}
+    std::vector<std::pair<int, std::pair<int, double>>> edges = {
+        {0, {1, 4.0}}, {1, {2, 1.0}}, {0, {2, 2.0}}, {3, {4, 7.0}}
+    };
+
+    BoruvkaSolver solver(2);
+    auto mst = solver.solve(5, edges);  // Must terminate on a disconnected graph
+    assert(mst.size() == 3);
+
+    double total = 0.0;
+    for (const auto& edge : mst) {
+        for (const auto& e : edges) {
+            if (e.first == edge.first && e.second.first == edge.second) total += e.second.second;
+        }
+    }
+    assert(total == 10.0);
+    std::cout << "testBoruvkaDisconnectedForest passed!" << std::endl;
+}
+
+void testKruskalFilterMatchesBoruvka() {
+    // Enough edges, and a tiny base case, so Filter-Kruskal actually partitions and filters
+    std::vector<std::pair<int, std::pair<int, double>>> edges;
+    for (int u = 0; u < 40; ++u) {
+        for (int v = u + 1; v < 40; ++v) {
+            edges.push_back({u, {v, double((u * 31 + v * 17) % 23)}});
+        }
+    }
+
+    auto weightOf = [&](const std::list<std::pair<int, int>>& mst) {
+        double total = 0.0;
+        for (const auto& edge : mst) {
+            for (const auto& e : edges) {
+                if (e.first == edge.first && e.second.first == edge.second) total += e.second.second;
+            }
+        }
+        return total;
+    };
+
+    KruskalSolver kruskal(2, 16);
+    BoruvkaSolver boruvka(2);
+    auto kruskalMST = kruskal.solve(40, edges);
+    auto boruvkaMST = boruvka.solve(40, edges);
+
+    assert(kruskalMST.size() == 39);
+    assert(weightOf(kruskalMST) == weightOf(boruvkaMST));
+    std::cout << "testKruskalFilterMatchesBoruvka passed!" << std::endl;
+}
+
+void testIndexedHeapDecreaseKey() {
+    IndexedDaryHeap<4> heap(6);
+    heap.push(0, 5.0);
+    heap.push(1, 3.0);
+    heap.push(2, 8.0);
+    heap.push(3, 1.0);
+
+    assert(heap.pushOrDecrease(2, 0.5));   // Decreased in place, no second entry
+    assert(!heap.pushOrDecrease(1, 4.0));  // Larger key is ignored
+    assert(heap.size() == 4);
+
+    int expectedOrder[] = {2, 3, 1, 0};
+    for (int id : expectedOrder) {
+        assert(heap.pop().first == id);
+        assert(!heap.contains(id));
+    }
+    assert(heap.empty());
+    std::cout << "testIndexedHeapDecreaseKey passed!" << std::endl;
+}
+
+void testCSRGraphCopyIsolation() {
+    CSRGraph original(4, 2);  // Small threshold so the copy compacts on its own
+    original.addEdge(0, 1, 1.0);
+    original.addEdge(1, 2, 2.0);  // Compacts: both edges are in the shared arrays now
+
+    CSRGraph copy = original;
+    copy.addEdge(2, 3, 3.0);
+    assert(copy.removeEdge(0, 1));
+    copy.compact();
+
+    assert(original.numEdges() == 2);
+    assert(original.contains(0, 1) && !original.contains(2, 3));
+    assert(original.compactedEdges() == 2);
+    assert(copy.numEdges() == 2);
+    assert(!copy.contains(0, 1) && copy.contains(2, 3));
+    std::cout << "testCSRGraphCopyIsolation passed!" << std::endl;
+}
+
+// Weight of (u, v) as seen through toEdgeList, or -1 if absent
+static double csrWeight(const CSRGraph& graph, int u, int v) {
+    for (const auto& edge : graph.toEdgeList()) {
+        if (std::minmax(edge.first, edge.second.first) == std::minmax(u, v))
+            return edge.second.second;
+    }
+    return -1.0;
+}
+
+void testCSRGraphDeltaMerge() {
+    // Bulk build with a repeated pair, then remove and re-add it through the delta buffer
+    std::vector<int> sources = {1, 2, 0};
+    std::vector<int> targets = {2, 1, 3};
+    std::vector<double> weights = {5.0, 7.0, 1.0};
+    CSRGraph graph(4, EdgeView{sources.data(), targets.data(), weights.data(), 3}, CSRGraph::LastRecordWins);
+    assert(graph.numEdges() == 2 && csrWeight(graph, 1, 2) == 7.0);
+
+    assert(graph.removeEdge(1, 2) && !graph.contains(2, 1));
+    graph.addEdge(2, 1, 3.0);
+    assert(graph.numEdges() == 2 && graph.pendingUpdates() == 1);
+    graph.compact();
+    assert(!graph.hasPendingUpdates() && graph.numEdges() == 2 && csrWeight(graph, 1, 2) == 3.0);
+    assert(graph.compactedEdges() == 2);
+
+    // Enough edits to freeze part of the buffer, on a copy that must stay unaffected
+    CSRGraph copy = graph;
+    for (int i = 0; i < 3 * int(CSRGraph::RecentEdits); ++i) {
+        graph.addEdge(i % 4, (i + 1) % 4, double(i));
+        if (i % 5 == 0)
+            graph.removeEdge(1, 2);
+    }
+    assert(graph.pendingUpdates() == 4);  // (0, 1), (1, 2), (2, 3) and (3, 0)
+    std::vector<double> before, after;
+    for (int u = 0; u < 4; ++u) {
+        before.push_back(csrWeight(graph, u, (u + 1) % 4));
+        before.push_back(csrWeight(graph, u, (u + 2) % 4));
+    }
+    graph.compact();
+    for (int u = 0; u < 4; ++u) {
+        after.push_back(csrWeight(graph, u, (u + 1) % 4));
+        after.push_back(csrWeight(graph, u, (u + 2) % 4));
+    }
+    assert(before == after && graph.numEdges() == 3 && !graph.contains(1, 2));  // Removed last at i = 190
+    assert(copy.numEdges() == 2 && csrWeight(copy, 1, 2) == 3.0 && !copy.contains(0, 1));
+    std::cout << "testCSRGraphDeltaMerge passed!" << std::endl;
+}
+
+// Edges of the compacted arrays as copyEdges() writes them
+static std::vector<WeightedEdge> copiedEdges(const CSRGraph& graph) {
+    size_t count = graph.compactedEdges();
+    std::vector<int> sources(count), targets(count);
+    std::vector<double> weights(count);
+    graph.copyEdges(sources.data(), targets.data(), weights.data());
+    std::vector<WeightedEdge> edges;
+    for (size_t e = 0; e < count; ++e)
+        edges.push_back({sources[e], targets[e], weights[e]});
+    return edges;
+}
+
+void testCSRGraphCopyEdges() {
+    std::vector<int> sources = {3, 0, 2, 1, 2};
+    std::vector<int> targets = {0, 2, 2, 0, 3};
+    std::vector<double> weights = {1.0, 2.0, 3.0, 4.0, 5.0};
+    CSRGraph graph(4, EdgeView{sources.data(), targets.data(), weights.data(), 5});
+
+    // Each edge once, u <= v, ordered by source then target; the self-loop appears once as well
+    std::vector<WeightedEdge> edges = copiedEdges(graph);
+    assert(edges.size() == 5);
+    std::vector<int> expectedSources = {0, 0, 0, 2, 2};
+    std::vector<int> expectedTargets = {1, 2, 3, 2, 3};
+    std::vector<double> expectedWeights = {4.0, 2.0, 1.0, 3.0, 5.0};
+    for (size_t e = 0; e < edges.size(); ++e) {
+        assert(edges[e].u == expectedSources[e] && edges[e].v == expectedTargets[e]);
+        assert(edges[e].weight == expectedWeights[e]);
+    }
+
+    // Only the compacted arrays are copied: pending edits show up after compact()
+    graph.addEdge(1, 3, 6.0);
+    assert(graph.removeEdge(0, 2));
+    assert(graph.compactedEdges() == 5);
+    graph.compact();
+    edges = copiedEdges(graph);
+    assert(edges.size() == 5 && edges[1].u == 0 && edges[1].v == 3);
+    assert(edges[2].u == 1 && edges[2].v == 3 && edges[2].weight == 6.0);
+
+    // Edge-centric solvers solve from the adjacency through a per-solve copy
+    MSTResult mst;
+    KruskalSolver().solve(graph, mst);
+    assert(mst.edges.size() == 3 && mst.totalWeight == 10.0);  // (0, 3), (0, 1) and (2, 3)
+    std::cout << "testCSRGraphCopyEdges passed!" << std::endl;
+}
+
+void testCSRGraphRebase() {
+    CSRGraph graph(5, CSRGraph::ManualCompaction);
+    graph.addEdge(0, 1, 1.0);
+    graph.addEdge(1, 2, 2.0);
+    CSRGraph older = graph;
+
+    // Edits after the snapshot: a new edge, a removal of a snapshot edge and one unchanged re-add
+    graph.addEdge(3, 4, 4.0);
+    assert(graph.removeEdge(0, 1));
+    graph.addEdge(1, 2, 2.0);
+
+    CSRGraph compacted = older;
+    compacted.compact();
+    assert(graph.rebase(older, compacted));
+    assert(graph.pendingUpdates() == 2);  // (3, 4) and the removal of (0, 1)
+    assert(graph.numEdges() == 2 && !graph.contains(0, 1) && graph.contains(1, 2) && graph.contains(3, 4));
+    assert(!graph.rebase(older, compacted));  // The arrays have been replaced since
+
+    graph.compact();
+    assert(graph.numEdges() == 2 && csrWeight(graph, 3, 4) == 4.0 && graph.compactedEdges() == 2);
+    std::cout << "testCSRGraphRebase passed!" << std::endl;
+}
+
+void testEdgeRecordParserSplitRecords() {
+    const char text[] = "1,2,0.5\r\n2 3 1.25\n\n3,1,2e1\nKruskal\n";
+    EdgeRecordParser parser(EdgeRecordParser::Text, 3);
+    size_t used = 0;
+    for (size_t i = 0; i < sizeof(text) - 1 && !parser.done(); ++i)
+        used += parser.consume(text + i, 1);  // One byte at a time: every record is split
+
+    assert(parser.done() && !parser.failed());
+    assert(std::string(text + used) == "Kruskal\n");  // Bytes after the last record are left alone
+    EdgeView edges = parser.edges();
+    assert(edges.size() == 3);
+    assert(edges.sources[1] == 2 && edges.targets[1] == 3 && edges.weights[1] == 1.25);
+    assert(edges.weights[2] == 20.0);
+
+    EdgeRecordParser malformed(EdgeRecordParser::Text, 2);
+    const char bad[] = "1,2,3\n1,x,3\n";
+    malformed.consume(bad, sizeof(bad) - 1);
+    assert(malformed.done() && malformed.failed());
+    std::cout << "testEdgeRecordParserSplitRecords passed!" << std::endl;
+}
+
+void testGraphFileRoundTrip() {
+    CSRGraph graph(5);
+    graph.addEdge(0, 1, 1.5);
+    graph.addEdge(1, 2, 2.5);
+    graph.addEdge(3, 4, 0.5);
+    MSTResult forest;
+    forest.add(0, 1, 1.5);
+
+    const std::string path = "/tmp/testsuite_graph.bin";
+    GraphFile::save(path, graph, &forest);
+    GraphFile::Loaded loaded = GraphFile::load(path);
+    unlink(path.c_str());  // The mapping stays valid
+
+    assert(loaded.graph.numVertices() == 5);
+    assert(loaded.graph.numEdges() == 3);
+    assert(loaded.graph.contains(2, 1) && !loaded.graph.contains(0, 2));
+    assert(loaded.forest.present && loaded.forest.count == 1 && loaded.forest.totalWeight == 1.5);
+
+    loaded.graph.addEdge(0, 2, 4.0);  // Edits on top of the mapped arrays go to the delta buffer
+    loaded.graph.compact();
+    assert(loaded.graph.numEdges() == 4 && loaded.graph.contains(0, 2));
+    std::cout << "testGraphFileRoundTrip passed!" << std::endl;
+}
+
+void testGraphFileRejectsCorruptArrays() {
+    CSRGraph graph(4);
+    graph.addEdge(0, 1, 1.0);
+    graph.addEdge(1, 2, 2.0);
+    graph.addEdge(2, 3, 3.0);
+    const std::string path = "/tmp/testsuite_corrupt.bin";
+    GraphFile::save(path, graph, nullptr);
+
+    std::ifstream in(path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    GraphFile::Header header;
+    memcpy(&header, bytes.data(), sizeof(header));
+
+    // Writes a copy with one value changed and expects the load to refuse it
+    auto expectCorrupt = [&](uint64_t offset, const void* value, size_t size) {
+        std::string damaged = bytes;
+        memcpy(&damaged[offset], value, size);
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << damaged;
+        bool rejected = false;
+        try {
+            GraphFile::load(path);
+        } catch (const std::runtime_error&) {
+            rejected = true;
+        }
+        assert(rejected);
+    };
+    uint64_t slots = header.numSlots;  // offsets[2] > offsets[3]
+    expectCorrupt(header.sections[0] + 2 * sizeof(uint64_t), &slots, sizeof(slots));
+    int outOfRange = 4;
+    expectCorrupt(header.sections[1] + sizeof(int), &outOfRange, sizeof(int));  // An adjacency target
+    uint64_t edges = header.numEdges + 1;  // An edge count that disagrees with the adjacency
+    expectCorrupt(offsetof(GraphFile::Header, numEdges), &edges, sizeof(edges));
+
+    unlink(path.c_str());
+    std::cout << "testGraphFileRejectsCorruptArrays passed!" << std::endl;
+}
+
+void testTreeAnalyticsForest() {
+    // Tree 0-1-2 plus 0-3-4, and a separate tree 5-6
+    std::vector<WeightedEdge> edges = {{0, 1, 10.0}, {0, 3, 5.0}, {1, 2, 1.0}, {3, 4, 2.0}, {5, 6, 7.0}};
+    TreeAnalytics analytics(7, edges);
+
+    assert(analytics.diameter() == 18.0);        // 2-1-0-3-4
+    assert(analytics.connectedPairs() == 11);    // 10 pairs in the first tree, 1 in the second
+    assert(analytics.sumOfDistances() == 109.0);  // 102 + 7
+    std::cout << "testTreeAnalyticsForest passed!" << std::endl;
+}
+
+void testLCAIndexDistances() {
+    std::vector<WeightedEdge> edges = {{0, 1, 10.0}, {0, 3, 5.0}, {1, 2, 1.0}, {3, 4, 2.0}, {5, 6, 7.0}};
+    TreeAnalytics analytics(7, edges);
+    LCAIndex index(analytics);
+
+    assert(index.lca(2, 4) == 0 && index.lca(2, 1) == 1 && index.lca(4, 4) == 4);
+    assert(index.distance(2, 4) == 18.0);
+    assert(index.distance(4, 5) == std::numeric_limits<double>::infinity());
+
+    std::vector<std::pair<int, int>> queries = {{2, 4}, {1, 2}, {6, 5}, {3, 3}};
+    std::vector<double> results;
+    index.distances(queries, results);
+    assert(results == std::vector<double>({18.0, 1.0, 7.0, 0.0}));
+    std::cout << "testLCAIndexDistances passed!" << std::endl;
+}
+
+void testMSTAnalyticsCommands() {
+    // Vertex 0 is unused, as on the server; tree 1-2-3 plus 1-4-5, and a separate tree 6-7
+    MSTResult forest;
+    forest.add(1, 2, 10.0);
+    forest.add(1, 4, 5.0);
+    forest.add(2, 3, 1.0);
+    forest.add(4, 5, 2.0);
+    forest.add(6, 7, 7.0);
+    MSTAnalytics analytics(8, forest);
+
+    assert(analytics.report("Weight") == "Total weight: 25.000000\n");
+    assert(analytics.report("Diameter") == "Diameter: 18.000000\n");
+    assert(analytics.report("Avgdist") == "Average distance: 9.909091\n");  // 109 / 11 pairs
+    assert(analytics.report("Distance 3,5") == "Distance: 18.000000\n");
+    assert(analytics.report("Distance 7,6") == "Distance: 7.000000\n");
+    assert(analytics.report("Distance 5,6") == "Distance: unreachable\n");
+    assert(analytics.report("Distance 0,1") == "Distance: unreachable\n");
+
+    // Malformed arguments and unknown vertices
+    auto rejects = [&](const std::string& command, bool usage) {
+        try {
+            analytics.report(command);
+        } catch (const std::invalid_argument& e) {
+            return usage && std::string(e.what()) == "usage: Distance u,v";
+        } catch (const std::out_of_range&) {
+            return !usage;
+        }
+        return false;
+    };
+    assert(rejects("Distance", true));
+    assert(rejects("Distance 3", true));
+    assert(rejects("Distance 3;5", true));
+    assert(rejects("Distance x,5", true));
+    assert(rejects("Distance 3,8", false));
+    assert(rejects("Distance -1,2", false));
+    std::cout << "testMSTAnalyticsCommands passed!" << std::endl;
+}
+
+// Random inserts, removals (one edit in removeOneIn) and re-weights, checked after every edit
+// against Kruskal on the current edge set. The CSR graph the forest reads non-tree edges from
+// compacts often, so both its arrays and its delta buffer are searched.
+static void checkDynamicMST(int n, unsigned removeOneIn, unsigned seed) {
+    std::mt19937 random(seed);
+    std::map<std::pair<int, int>, double> graph;
+    CSRGraph csr(n, 16);
+    std::vector<int> sources, targets;
+    std::vector<double> weights;
+    auto solve = [&](MSTResult& mst) {
+        sources.clear();
+        targets.clear();
+        weights.clear();
+        for (const auto& edge : graph) {
+            sources.push_back(edge.first.first);
+            targets.push_back(edge.first.second);
+            weights.push_back(edge.second);
+        }
+        KruskalSolver().solve(n, EdgeView{sources.data(), targets.data(), weights.data(), sources.size()}, mst);
+    };
+
+    // Seeded from a solved graph, as the server does
+    for (int i = 0; i < 40; ++i) {
+        int u = int(random() % n), v = int(random() % n);
+        if (u != v) {
+            graph[{std::min(u, v), std::max(u, v)}] = double(1 + random() % 50);
+            csr.addEdge(u, v, graph[{std::min(u, v), std::max(u, v)}]);
+        }
+    }
+    MSTResult expected, maintained;
+    solve(expected);
+    DynamicMST dynamic(n);
+    dynamic.build(expected);
+
+    for (int step = 0; step < 3000; ++step) {
+        int u = int(random() % n), v = int(random() % n);
+        if (u == v)
+            continue;
+        std::pair<int, int> key(std::min(u, v), std::max(u, v));
+        if (random() % removeOneIn == 0) {
+            graph.erase(key);
+            csr.removeEdge(u, v);
+            dynamic.removeEdge(u, v, csr);  // A missing edge is ignored
+        } else {
+            double weight = double(1 + random() % 50);  // Inserts, or re-weights an existing edge
+            graph[key] = weight;
+            csr.addEdge(u, v, weight);
+            dynamic.insertEdge(v, u, weight, csr);
+        }
+
+        solve(expected);
+        dynamic.collect(maintained);
+        assert(maintained.edges.size() == expected.edges.size());
+        assert(maintained.totalWeight == expected.totalWeight);
+        double sum = 0;
+        for (const WeightedEdge& edge : maintained.edges) {
+            auto it = graph.find({std::min(edge.u, edge.v), std::max(edge.u, edge.v)});
+            assert(it != graph.end() && it->second == edge.weight);
+            sum += edge.weight;
+        }
+        assert(sum == maintained.totalWeight);
+    }
+}
+
+void testDynamicMSTMatchesKruskal() {
+    checkDynamicMST(24, 3, 11);  // Grows dense: deletions mostly find a replacement edge
+    checkDynamicMST(60, 2, 5);   // Stays sparse: many cuts split a tree for good
+    std::cout << "testDynamicMSTMatchesKruskal passed!" << std::endl;
+}
+
+void testSolverWorkspaceReuse() {
+    // Large enough to outgrow the workspace's initial arena on the first solve
+    std::vector<int> sources, targets;
+    std::vector<double> weights;
+    for (int u = 0; u < 20000; ++u) {
+        for (int step = 1; step <= 3; ++step) {
+            sources.push_back(u);
+            targets.push_back((u * 7 + step * 13) % 20000);
+            weights.push_back(double((u * 31 + step) % 97));
+        }
+    }
+    EdgeView edges{sources.data(), targets.data(), weights.data(), sources.size()};
+
+    SolverWorkspace& workspace = SolverWorkspace::local();
+    BoruvkaSolver boruvka(2);
+    KruskalSolver kruskal(2, 1024);
+    MSTResult first, second;
+    boruvka.solve(20000, edges, first);
+    kruskal.solve(20000, edges, first);
+
+    // Steady state: the arena serves every request and the heap is not touched
+    SolverWorkspace::Counters before = workspace.counters();
+    boruvka.solve(20000, edges, second);
+    assert(second.totalWeight == first.totalWeight);
+    kruskal.solve(20000, edges, second);
+    SolverWorkspace::Counters after = workspace.counters();
+
+    assert(second.totalWeight == first.totalWeight);
+    assert(after.heapAllocations == before.heapAllocations);
+    assert(after.arenaAllocations > before.arenaAllocations);
+    assert(after.solves == before.solves + 2);
+    std::cout << "testSolverWorkspaceReuse passed!" << std::endl;
+}
+
+void testEdgeKernelsMatchScalar() {
+    // 37 edges: full vector blocks plus a scalar tail at every level
+    std::vector<int> label = {0, 0, 2, 2, 4, 5, 5, 7};
+    std::vector<int> u, v, id;
+    std::vector<double> w;
+    for (int i = 0; i < 37; ++i) {
+        u.push_back((i * 3) % 8);
+        v.push_back((i * 5 + 1) % 8);
+        w.push_back(i * 0.5);
+        id.push_back(i);
+    }
+
+    EdgeKernels::Level original = EdgeKernels::level();
+    std::vector<int> expectedU, expectedV, expectedId;
+    std::vector<double> expectedW;
+    for (int level = EdgeKernels::Scalar; level <= EdgeKernels::supported(); ++level) {
+        EdgeKernels::level() = EdgeKernels::Level(level);
+        std::vector<int> lu(u.size()), lv(u.size());
+        EdgeKernels::endpointLabels(label.data(), u.data(), v.data(), lu.data(), lv.data(), u.size());
+        for (size_t i = 0; i < u.size(); ++i)
+            assert(lu[i] == label[u[i]] && lv[i] == label[v[i]]);
+
+        std::vector<int> cu = u, cv = v, cid = id;
+        std::vector<double> cw = w;
+        size_t kept = EdgeKernels::keepCrossing(label.data(), cu.data(), cv.data(), cw.data(), cid.data(), cu.size());
+        cu.resize(kept), cv.resize(kept), cw.resize(kept), cid.resize(kept);
+        if (level == EdgeKernels::Scalar) {
+            expectedU = cu, expectedV = cv, expectedW = cw, expectedId = cid;
+            for (size_t i = 0; i < kept; ++i)
+                assert(label[cu[i]] != label[cv[i]] && cw[i] == cid[i] * 0.5);
+        }
+        assert(cu == expectedU && cv == expectedV && cw == expectedW && cid == expectedId);
+    }
+    EdgeKernels::level() = original;
+    std::cout << "testEdgeKernelsMatchScalar passed!" << std::endl;
+}
+
+void testCompactWeightSolvers() {
+    assert(classifyWeights(EdgeView{nullptr, nullptr, nullptr, 0}) == IntegerWeights);
+    std::vector<int> sources, targets;
+    std::vector<double> weights;
+    for (int u = 0; u < 300; ++u) {
+        for (int step = 1; step <= 4; ++step) {
+            sources.push_back(u);
+            targets.push_back((u * 11 + step * 7) % 300);
+            weights.push_back(double((u * 37 + step * 101) % 5000));
+        }
+    }
+    EdgeView edges{sources.data(), targets.data(), weights.data(), sources.size()};
+    assert(classifyWeights(edges) == IntegerWeights);
+
+    MSTResult expected, actual;
+    KruskalSolver(2, 64).solve(300, edges, expected);
+    BasicKruskalSolver<uint32_t, uint32_t>(2, 64).solveEdges(300, edges, actual);  // Radix-sorted
+    assert(actual.totalWeight == expected.totalWeight && actual.edges.size() == expected.edges.size());
+    BasicBoruvkaSolver<uint32_t, uint32_t>(2).solveEdges(300, edges, actual);
+    assert(actual.totalWeight == expected.totalWeight);
+
+    // Halves are exact in a float; a negative weight rules out the integer path
+    for (double& w : weights)
+        w = w / 2 - 3.0;
+    assert(classifyWeights(edges) == FloatWeights);
+    KruskalSolver(2, 64).solve(300, edges, expected);
+    BasicKruskalSolver<uint32_t, float>(2, 64).solveEdges(300, edges, actual);
+    assert(actual.totalWeight == expected.totalWeight);
+
+    weights[0] = 0.1;  // Not exact in a float
+    assert(classifyWeights(edges) == DoubleWeights);
+    bool rejected = false;
+    try {
+        BasicKruskalSolver<uint32_t, float>().solveEdges(300, edges, actual);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    assert(rejected);
+    std::cout << "testCompactWeightSolvers passed!" << std::endl;
+}
+
+void testExternalMSTMatchesKruskal() {
+    // 200000 f64 records (3.2 MB) under a 2.5 MB budget: several runs and an intermediate merge pass
+    const char* path = "/tmp/test_external_mst.bin";
+    std::vector<int> sources, targets;
+    std::vector<double> weights;
+    FILE* file = fopen(path, "wb");
+    assert(file);
+    for (uint32_t i = 0; i < 200000; ++i) {
+        uint32_t u = (i * 7919) % 20000, v = (i * 104729 + 13) % 20000;
+        double w = double((i * 2654435761u) % 100000) / 4;
+        fwrite(&u, sizeof(u), 1, file);
+        fwrite(&v, sizeof(v), 1, file);
+        fwrite(&w, sizeof(w), 1, file);
+        sources.push_back(int(u));
+        targets.push_back(int(v));
+        weights.push_back(w);
+    }
+    fclose(file);
+
+    MSTResult expected, actual;
+    KruskalSolver().solve(20000, EdgeView{sources.data(), targets.data(), weights.data(), sources.size()}, expected);
+
+    ExternalMSTSolver::Options options;
+    options.memoryBudget = 2500000;
+    int reports = 0;
+    options.progress = [&reports](const ExternalMSTSolver::Progress&) { reports++; };
+    ExternalMSTSolver::Summary summary = ExternalMSTSolver(options).solve(path, ExternalMSTSolver::Binary64, actual);
+    remove(path);
+
+    assert(summary.numEdges == 200000 && summary.runs > 2 && summary.mergePasses > 1 && reports > 0);
+    assert(actual.edges.size() == expected.edges.size() && actual.totalWeight == expected.totalWeight);
+    std::cout << "testExternalMSTMatchesKruskal passed!" << std::endl;
+}
+
+void testPartitionedWorkerList() {
+    std::vector<PartitionedMSTSolver::Worker> workers =
+        PartitionedMSTSolver::parseWorkers("127.0.0.1:9001,node-b:9002,[::1]:9003");
+    assert(workers.size() == 3);
+    assert(workers[0].host == "127.0.0.1" && workers[0].port == 9001);
+    assert(workers[1].host == "node-b" && workers[1].port == 9002);
+    assert(workers[2].host == "::1" && workers[2].port == 9003);
+
+    const char* bad[] = {"", "node-b", "node-b:", ":9001", "node-b:0", "node-b:70000", "node-b:90x", "a:1,,b:2"};
+    for (const char* list : bad) {
+        bool rejected = false;
+        try {
+            PartitionedMSTSolver::parseWorkers(list);
+        } catch (const std::invalid_argument&) {
+            rejected = true;
+        }
+        assert(rejected);
+    }
+    std::cout << "testPartitionedWorkerList passed!" << std::endl;
+}
+
+void testGraphGeneratorReproducible() {
+    GraphGenerator first(7), second(7), other(8);
+    GeneratedGraph a = first.rmat(10, 5000), b = second.rmat(10, 5000), c = other.rmat(10, 5000);
+    assert(a.numEdges() == 5000 && a.numVertices == 1024);
+    assert(a.sources == b.sources && a.targets == b.targets && a.weights == b.weights);
+    assert(a.sources != c.sources);
+
+    GeneratedGraph grid = GraphGenerator(1).grid(3, 4);
+    assert(grid.numVertices == 12 && grid.numEdges() == size_t(3 * 3 + 2 * 4));
+    GeneratedGraph complete = GraphGenerator(1, GraphGenerator::UnitReals).complete(20);
+    assert(complete.numEdges() == 190);
+    GeneratedGraph uniform = GraphGenerator(1).uniform(50, 400);
+    for (const GeneratedGraph* graph : {&a, &grid, &complete, &uniform}) {
+        for (size_t e = 0; e < graph->numEdges(); ++e) {
+            assert(graph->sources[e] != graph->targets[e]);
+            assert(graph->sources[e] >= 0 && graph->sources[e] < graph->numVertices);
+            assert(graph->targets[e] >= 0 && graph->targets[e] < graph->numVertices);
+            assert(graph->weights[e] >= 0.0 && (graph == &complete ? graph->weights[e] < 1.0 : graph->weights[e] >= 1.0));
+        }
+    }
+
+    // A grid is connected: its MST spans every vertex
+    MSTResult mst;
+    KruskalSolver().solve(grid.numVertices, grid.view(), mst);
+    assert(mst.edges.size() == size_t(grid.numVertices - 1));
+    std::cout << "testGraphGeneratorReproducible passed!" << std::endl;
+}
+
+void testLatencyHistogramPercentiles() {
+    LatencyHistogram histogram;
+    assert(histogram.count() == 0 && histogram.percentile(50) == 0);
+    for (uint64_t v = 1; v <= 100000; ++v)
+        histogram.record(v * 1000);  // 1 us .. 100 ms in nanoseconds
+    assert(histogram.count() == 100000 && histogram.min() == 1000 && histogram.max() == 100000000);
+
+    // Each percentile is within the 1/128 bucket precision of the exact value
+    const double percentiles[] = {50, 90, 99, 99.9};
+    for (double p : percentiles) {
+        double exact = p * 1000.0 * 1000.0;
+        double reported = double(histogram.percentile(p));
+        assert(reported >= exact && reported <= exact * (1 + 1.0 / 128));
+    }
+    assert(histogram.percentile(100) == histogram.max());
+
+    // Small values are exact, and merging adds the samples of both sides
+    LatencyHistogram small, merged;
+    for (uint64_t v = 0; v < 200; ++v)
+        small.record(v);
+    assert(small.percentile(50) == 99 && small.countAtOrBelow(9) == 10);
+    merged.merge(small);
+    merged.merge(histogram);
+    assert(merged.count() == 100200 && merged.min() == 0 && merged.max() == histogram.max());
+    std::cout << "testLatencyHistogramPercentiles passed!" << std::endl;
+}
+
+void testMetricsPrometheusExport() {
+    assert(Metrics::classify("Prim4") == Metrics::Prim && Metrics::classify("Stats") == Metrics::Stats &&
+           Metrics::classify("Frobnicate 1,2") == Metrics::Other);
+
+    Metrics::Totals before;
+    Metrics::collect(before);
+    std::thread worker([] {
+        Metrics::record(Metrics::Solve, std::chrono::microseconds(20));
+        Metrics::count(Metrics::Kruskal);
+        Metrics::add(Metrics::BytesRead, 100);
+    });
+    worker.join();
+    Metrics::record(Metrics::Solve, std::chrono::milliseconds(2));
+
+    // Both threads' slots are summed
+    Metrics::Totals after;
+    Metrics::collect(after);
+    assert(after.stages[Metrics::Solve].count() == before.stages[Metrics::Solve].count() + 2);
+    assert(after.commands[Metrics::Kruskal] == before.commands[Metrics::Kruskal] + 1);
+    assert(after.counters[Metrics::BytesRead] == before.counters[Metrics::BytesRead] + 100);
+
+    // Buckets are cumulative: the 20 us sample is under 50 us, both are under 5 ms
+    Metrics::Totals fresh;
+    fresh.stages[Metrics::Solve].record(20000);
+    fresh.stages[Metrics::Solve].record(2000000);
+    std::string text = Metrics::prometheus(fresh);
+    assert(text.find("mst_stage_seconds_bucket{stage=\"solve\",le=\"1e-05\"} 0\n") != std::string::npos);
+    assert(text.find("mst_stage_seconds_bucket{stage=\"solve\",le=\"5e-05\"} 1\n") != std::string::npos);
+    assert(text.find("mst_stage_seconds_bucket{stage=\"solve\",le=\"0.005\"} 2\n") != std::string::npos);
+    assert(text.find("mst_stage_seconds_count{stage=\"solve\"} 2\n") != std::string::npos);
+    assert(text.find("mst_commands_total{command=\"other\"} 0\n") != std::string::npos);
+    std::cout << "testMetricsPrometheusExport passed!" << std::endl;
+}
+
+void testJobTableCancellation() {
+    JobTable jobs(2);
+    std::vector<std::string> replies;
+    JobTable::Reply collect = [&](std::string result) { replies.push_back(result); };
+
+    // Queued -> Running -> Finished; a waiter registered before the end gets the result
+    std::shared_ptr<JobTable::Job> first = jobs.submit();
+    JobTable::State state;
+    assert(jobs.poll(first->id, state) && state == JobTable::Queued);
+    assert(jobs.start(*first));
+    assert(jobs.wait(first->id, collect) && replies.empty());
+    jobs.finish(*first, "done\n");
+    assert(replies.size() == 1 && replies[0] == "done\n");
+    assert(jobs.wait(first->id, collect) && replies.size() == 2 && replies[1] == "done\n");
+
+    // Cancelling a queued job ends it at once, and its work never starts
+    std::shared_ptr<JobTable::Job> queued = jobs.submit();
+    assert(jobs.wait(queued->id, collect));
+    assert(jobs.cancel(queued->id, state) && state == JobTable::Queued);
+    assert(replies.size() == 3 && replies[2] == "Job " + std::to_string(queued->id) + " cancelled\n");
+    assert(!jobs.start(*queued));
+
+    // A running solve stops at its next cancellation point
+    std::shared_ptr<JobTable::Job> running = jobs.submit();
+    assert(jobs.start(*running));
+    assert(jobs.cancel(running->id, state) && state == JobTable::Running);
+    std::vector<std::pair<int, std::pair<int, double>>> edges = {{0, {1, 1.0}}, {1, {2, 2.0}}, {0, {2, 3.0}}};
+    bool stopped = false;
+    try {
+        CancellationScope scope(running->cancellation);
+        BoruvkaSolver().solve(3, edges);
+    } catch (const OperationCancelled&) {
+        stopped = true;
+    }
+    assert(stopped);
+    jobs.finish(*running, "", true);
+    assert(jobs.poll(running->id, state) && state == JobTable::Cancelled);
+
+    // Only the last two ended jobs are retained; without a scope nothing is cancelled
+    assert(!jobs.poll(first->id, state) && jobs.poll(queued->id, state));
+    assert(BoruvkaSolver().solve(3, edges).size() == 2);
+    std::cout << "testJobTableCancellation passed!" << std::endl;
+}
+
+void testRevisionCacheSingleFlight() {
+    const int callers = 4;
+    RevisionCache<std::string> cache;
+    std::atomic<int> computations(0);
+
+    // Concurrent callers for one revision share a single computation: it finishes only once every
+    // other caller has found its in-flight entry
+    auto compute = [&](uint64_t waitForHits, bool fail) {
+        return [&, waitForHits, fail]() -> std::string {
+            computations++;
+            while (cache.hits() < waitForHits)
+                std::this_thread::yield();
+            if (fail)
+                throw std::runtime_error("solver failed");
+            return "MST\n";
+        };
+    };
+    auto run = [&](uint64_t revision, uint64_t waitForHits, bool fail, std::vector<std::string>& results) {
+        std::vector<std::thread> threads;
+        std::mutex resultMutex;
+        for (int i = 0; i < callers; ++i) {
+            threads.emplace_back([&] {
+                std::string result;
+                try {
+                    result = *cache.getOrCompute(1, revision, "Kruskal", compute(waitForHits, fail));
+                } catch (const std::runtime_error& e) {
+                    result = e.what();
+                }
+                std::lock_guard<std::mutex> lock(resultMutex);
+                results.push_back(result);
+            });
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+    };
+
+    std::vector<std::string> results;
+    run(1, callers - 1, false, results);
+    assert(computations == 1 && cache.misses() == 1 && cache.hits() == callers - 1);
+    assert(std::count(results.begin(), results.end(), "MST\n") == callers);
+
+    // A failed computation reaches every caller waiting on it and is not cached: the next
+    // request for the revision computes again
+    results.clear();
+    run(2, 2 * (callers - 1), true, results);
+    assert(computations == 2 && std::count(results.begin(), results.end(), "solver failed") == callers);
+    assert(*cache.getOrCompute(1, 2, "Kruskal", compute(0, false)) == "MST\n" && computations == 3);
+    assert(*cache.getOrCompute(1, 2, "Kruskal", compute(0, true)) == "MST\n" && computations == 3);
+
+    // A failure must not drop an entry that replaced its own after an eviction
+    RevisionCache<std::string> small(1);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::thread failing([&] {
+        try {
+            small.getOrCompute(1, 1, "Prim", [&]() -> std::string {
+                released.wait();
+                throw std::runtime_error("solver failed");
+            });
+        } catch (const std::runtime_error&) {
+        }
+    });
+    while (small.misses() == 0)
+        std::this_thread::yield();
+    small.getOrCompute(2, 1, "Prim", [] { return std::string("other graph\n"); });  // Evicts (1, 1)
+    small.getOrCompute(1, 1, "Prim", [] { return std::string("MST\n"); });         // Evicts (2, 1)
+    release.set_value();
+    failing.join();
+    bool recomputed = false;
+    assert(*small.getOrCompute(1, 1, "Prim", [&] {
+        recomputed = true;
+        return std::string("again\n");
+    }) == "MST\n");
+    assert(!recomputed);
+    std::cout << "testRevisionCacheSingleFlight passed!" << std::endl;
+}
+
+void testChaseLevDequeStress() {
+    // The owner pushes and pops while three thieves steal; every item must come out exactly once.
+    // A tiny initial ring makes the deque grow while thieves read it.
+    const int items = 200000;
+    std::vector<int> values(items);
+    std::vector<std::atomic<int>> taken(items);
+    for (int i = 0; i < items; ++i) {
+        values[i] = i;
+        taken[i] = 0;
+    }
+    ChaseLevDeque<int> deque(2);
+    std::atomic<bool> done(false);
+    std::atomic<int> stolen(0);
+    auto take = [&](int* item) {
+        taken[*item].fetch_add(1, std::memory_order_relaxed);
+    };
+
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 3; ++t) {
+        thieves.emplace_back([&] {
+            while (!done.load(std::memory_order_acquire) || !deque.empty()) {
+                if (int* item = deque.steal()) {
+                    take(item);
+                    stolen.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    std::mt19937 random(3);
+    for (int i = 0; i < items; ++i) {
+        deque.push(&values[i]);
+        if (random() % 3 == 0) {
+            if (int* item = deque.pop())
+                take(item);
+        }
+    }
+    while (int* item = deque.pop())
+        take(item);
+    done.store(true, std::memory_order_release);
+    for (std::thread& thief : thieves)
+        thief.join();
+
+    for (int i = 0; i < items; ++i)
+        assert(taken[i].load() == 1);
+    assert(deque.empty() && deque.pop() == nullptr && deque.steal() == nullptr);
+    assert(stolen.load() > 0);
+    std::cout << "testChaseLevDequeStress passed!" << std::endl;
+}
+
+// Runs a function as a pool task
+class FunctionTask : public Task {
+public:
+    explicit FunctionTask(std::function<void()> body) : body(std::move(body)) {}
+
+    void execute() override {
+        body();
+    }
+
+private:
+    std::function<void()> body;
+};
+
+void testThreadPoolLanes() {
+    ThreadPool pool(3);
+    std::atomic<int> finished(0);
+    auto waitFor = [&](int count) {
+        for (int i = 0; i < 100000 && finished.load() < count; ++i)
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        assert(finished.load() == count);
+    };
+
+    // Background tasks never occupy more than size() - 1 workers: an interactive task still runs
+    // while every other worker is stuck in a solve
+    std::atomic<bool> release(false);
+    std::atomic<int> running(0), peak(0);
+    for (int i = 0; i < 4; ++i) {
+        pool.enqueue(new FunctionTask([&] {
+            int now = ++running;
+            int seen = peak.load();
+            while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+            }
+            while (!release.load())
+                std::this_thread::yield();
+            --running;
+            ++finished;
+        }), ThreadPool::Background);
+    }
+    for (int i = 0; i < 100000 && running.load() < 2; ++i)
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    pool.enqueue(new FunctionTask([&] { ++finished; }), ThreadPool::Interactive);
+    waitFor(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));  // The idle worker leaves the rest queued
+    assert(running.load() == 2);
+    release = true;
+    waitFor(5);
+    assert(peak.load() == 2);
+
+    // Fork-join from a worker: pieces are stolen by idle workers, each runs once
+    std::vector<std::atomic<int>> pieces(64);
+    for (std::atomic<int>& piece : pieces)
+        piece = 0;
+    pool.enqueue(new FunctionTask([&] {
+        pool.runAll(pieces.size(), [&](size_t i) { pieces[i]++; });
+        ++finished;
+    }), ThreadPool::Background);
+    for (int i = 0; i < 200; ++i)
+        pool.enqueue(new FunctionTask([&] { ++finished; }), i % 2 ? ThreadPool::Interactive : ThreadPool::Background);
+    waitFor(206);
+    for (std::atomic<int>& piece : pieces)
+        assert(piece.load() == 1);
+    std::cout << "testThreadPoolLanes passed!" << std::endl;
+}
+
+struct PooledValue {
+    static std::atomic<int> live;
+    int value;
+
+    explicit PooledValue(int value) : value(value) {
+        ++live;
+    }
+
+    ~PooledValue() {
+        --live;
+    }
+};
+
+std::atomic<int> PooledValue::live(0);
+
+void testObjectPoolAcrossThreads() {
+    ObjectPool<PooledValue> pool;
+
+    // A slot released on this thread is the next one handed out
+    PooledValue* first = pool.acquire(1);
+    pool.release(first);
+    PooledValue* second = pool.acquire(2);
+    assert(second == first && second->value == 2);
+    pool.release(second);
+
+    // Objects created on one thread and released on another: the releasing thread's overflow goes
+    // back through the shared list, and every object is built and destroyed exactly once
+    for (int round = 0; round < 4; ++round) {
+        std::vector<PooledValue*> objects;
+        for (int i = 0; i < 500; ++i)
+            objects.push_back(pool.acquire(i));
+        for (int i = 0; i < 500; ++i)
+            assert(objects[i]->value == i);
+        std::thread releaser([&] {
+            for (PooledValue* object : objects)
+                pool.release(object);
+        });
+        releaser.join();
+        assert(PooledValue::live.load() == 0);
+    }
+    std::cout << "testObjectPoolAcrossThreads passed!" << std::endl;
+}
+
+// Everything the peer has written to a non-blocking socket so far
+static std::string drainSocket(int fd) {
+    std::string received;
+    char buffer[65536];
+    ssize_t n;
+    while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+        received.append(buffer, size_t(n));
+    return received;
+}
+
+// Steps the loop while reading the client end, until `expected` bytes have arrived or it stalls
+static std::string receive(EventLoop& loop, int client, size_t expected) {
+    std::string received = drainSocket(client);
+    for (int round = 0; round < 2000 && received.size() < expected; ++round) {
+        loop.runOnce(5);
+        received += drainSocket(client);
+    }
+    return received;
+}
+
+void testEventLoopFraming() {
+    EventLoop* loop = nullptr;
+    std::vector<std::string> commands;
+    bool answer = true;  // Otherwise the test completes commands itself
+    const std::string big(1 << 20, 'x');
+    EventLoop eventLoop(0, [&](uint64_t id, std::string command, std::shared_ptr<PayloadReader>) {
+        commands.push_back(command);
+        if (answer)
+            loop->complete(id, command == "Big" ? big + "\n" : "ok " + command + "\n");
+    }, nullptr, 1 << 20, 2);
+    loop = &eventLoop;
+
+    int fds[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    int client = fds[0];
+    fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+    int small = 4096;  // Forces the loop's big response out in many partial sends
+    setsockopt(fds[1], SOL_SOCKET, SO_SNDBUF, &small, sizeof(small));
+    setsockopt(client, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+    uint64_t id = eventLoop.adopt(fds[1]);
+    auto transmit = [&](const std::string& data) {
+        assert(write(client, data.data(), data.size()) == ssize_t(data.size()));
+    };
+
+    // Pipelined commands in one write are answered one at a time, in order
+    transmit("A\nB\nC\n");
+    std::string expected = "ok A\nok B\nok C\n";
+    assert(receive(eventLoop, client, expected.size()) == expected);
+
+    // Lines split across writes, with a CRLF ending
+    transmit("Hel");
+    eventLoop.runOnce(5);
+    transmit("lo\r\nWor");
+    eventLoop.runOnce(5);
+    transmit("ld\n");
+    expected = "ok Hello\nok World\n";
+    assert(receive(eventLoop, client, expected.size()) == expected);
+
+    // A response much larger than the socket buffers, followed by a pipelined command
+    transmit("Big\nAfter\n");
+    expected = big + "\nok After\n";
+    assert(receive(eventLoop, client, expected.size()) == expected);
+
+    // With two commands queued behind a running one, the loop stops reading the connection
+    answer = false;
+    commands.clear();
+    transmit("c0\nc1\nc2\n");
+    eventLoop.runOnce(5);
+    transmit("c3\n");
+    for (int i = 0; i < 3; ++i)
+        eventLoop.runOnce(5);
+    int unread = 0;
+    assert(ioctl(fds[1], FIONREAD, &unread) == 0 && unread == 3 && commands.size() == 1);
+    eventLoop.complete(id, "ok c0\n");  // c1 starts, the queue has room again and c3 is read
+    eventLoop.runOnce(5);
+    assert(ioctl(fds[1], FIONREAD, &unread) == 0 && unread == 0 && commands.size() == 2);
+    answer = true;
+    eventLoop.complete(id, "ok c1\n");
+    expected = "ok c0\nok c1\nok c2\nok c3\n";
+    assert(receive(eventLoop, client, expected.size()) == expected);
+    assert(commands == std::vector<std::string>({"c0", "c1", "c2", "c3"}));
+
+    close(client);
+    std::cout << "testEventLoopFraming passed!" << std::endl;
+}
+
 int main() {
     testGraphCreation();
     testAddEdge();
@@ -127,6 +1232,35 @@ int main() {
     testEdgeUpdate();
     testGetNeighbors();
     testNonExistentVertex();
+    testEdgeIndexChurn();
+    testBoruvkaDisconnectedForest();
+    testKruskalFilterMatchesBoruvka();
+    testIndexedHeapDecreaseKey();
+    testCSRGraphCopyIsolation();
+    testCSRGraphDeltaMerge();
+    testCSRGraphCopyEdges();
+    testCSRGraphRebase();
+    testEdgeRecordParserSplitRecords();
+    testGraphFileRoundTrip();
+    testGraphFileRejectsCorruptArrays();
+    testTreeAnalyticsForest();
+    testLCAIndexDistances();
+    testMSTAnalyticsCommands();
+    testDynamicMSTMatchesKruskal();
+    testSolverWorkspaceReuse();
+    testEdgeKernelsMatchScalar();
+    testCompactWeightSolvers();
+    testExternalMSTMatchesKruskal();
+    testPartitionedWorkerList();
+    testGraphGeneratorReproducible();
+    testLatencyHistogramPercentiles();
+    testMetricsPrometheusExport();
+    testJobTableCancellation();
+    testRevisionCacheSingleFlight();
+    testChaseLevDequeStress();
+    testThreadPoolLanes();
+    testObjectPoolAcrossThreads();
+    testEventLoopFraming();
 
     std::cout << "All tests passed!" << std::endl;
     return 0;
@@ -0,0 +1,399 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include "ChaseLevDeque.cpp"
+#include "ParallelFor.cpp"
+
+// Task class for representing work that needs to be done by a thread in the thread pool
+class Task {
+public:
+    virtual void execute() = 0;
+
+    // Called by the pool once execute() returned; recycled tasks override this
+    virtual void release() {
+        delete this;
+    }
+
+    virtual ~Task() {}
+};
+
+// Work-stealing thread pool.
+// Tasks submitted from outside are spread round-robin over per-worker inboxes (one small lock per
+// worker instead of one shared queue). Each worker also owns a Chase-Lev deque that holds the
+// fork-join pieces of parallel solvers: a solver running on a worker pushes its chunks there,
+// idle workers steal them, and the forking thread helps until all chunks are done. Waiting
+// threads only ever help with deque work, never with inbox tasks, so a task cannot end up
+// blocked underneath another request it is waiting for.
+// Submitted tasks go to one of two lanes. Interactive tasks (cheap commands such as edge edits)
+// are always taken first. Background tasks (solves) wait in a shared queue and never occupy more
+// than backgroundLimit workers, one less than the pool by default, so however many large solves
+// are queued one worker stays free for interactive work (a single-worker pool cannot keep one free).
+class ThreadPool : public ParallelExecutor {
+public:
+    enum Lane { Interactive, Background };
+
+    ThreadPool(size_t numThreads, bool pinThreads = false)
+        : stop(false), sleepers(0), nextInbox(0), numWorkers(numThreads == 0 ? 1 : numThreads),
+          backgroundLimit(numWorkers > 1 ? numWorkers - 1 : 1), backgroundSize(0), backgroundRunning(0) {
+        for (size_t i = 0; i < numWorkers; ++i)
+            workers.emplace_back(new Worker());
+        for (size_t i = 0; i < numWorkers; ++i) {
+            workers[i]->thread = std::thread([this, i] { workerLoop(i); });
+            if (pinThreads)
+                pin(workers[i]->thread, i);
+        }
+    }
+
+    // Add a new task to the thread pool
+    void enqueue(Task* task, Lane lane = Interactive) {
+        if (lane == Background) {
+            {
+                std::lock_guard<std::mutex> lock(backgroundMutex);
+                background.push_back(task);
+                backgroundSize.fetch_add(1, std::memory_order_seq_cst);
+            }
+            wakeOne();
+            return;
+        }
+
+        Worker& target = *workers[nextInbox.fetch_add(1, std::memory_order_relaxed) % numWorkers];
+        {
+            std::lock_guard<std::mutex> lock(target.inboxMutex);
+            target.inbox.push_back(task);
+            target.inboxSize.fetch_add(1, std::memory_order_release);
+        }
+        wakeOne();
+    }
+
+    size_t size() const {
+        return numWorkers;
+    }
+
+    // The pool whose worker is running the caller, or nullptr on any other thread
+    static ThreadPool* current() {
+        return workerPool();
+    }
+
+    unsigned concurrency() const override {
+        return unsigned(numWorkers);
+    }
+
+    // Fork-join: from a worker, the pieces go to its deque; from any other thread they are
+    // simply run inline one after another.
+    void runAll(size_t count, const std::function<void(size_t)>& body) override {
+        int self = currentWorkerIndex();
+        if (self < 0 || workerPool() != this) {
+            for (size_t i = 0; i < count; ++i)
+                body(i);
+            return;
+        }
+
+        std::atomic<size_t> remaining(count - 1);
+        std::vector<ChunkTask> chunks;
+        chunks.reserve(count - 1);
+        for (size_t i = 1; i < count; ++i)
+            chunks.push_back(ChunkTask(body, i, remaining));
+
+        Worker& me = *workers[self];
+        for (ChunkTask& chunk : chunks)
+            me.local.push(&chunk);
+        wakeAll();
+
+        body(0);
+
+        // Help with outstanding pieces (ours or anyone's) until every piece of ours has finished
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            Task* task = me.local.pop();
+            if (!task)
+                task = stealLocal(size_t(self));
+            if (task)
+                runTask(task);
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    // Destructor to join all threads
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stop.store(true);
+        }
+        wake.notify_all();
+        for (auto& worker : workers)
+            worker->thread.join();
+    }
+
+private:
+    struct Worker {
+        std::thread thread;
+        ChaseLevDeque<Task> local;  // Fork-join pieces
+        std::mutex inboxMutex;
+        std::deque<Task*> inbox;    // Submitted tasks
+        std::atomic<size_t> inboxSize{0};
+    };
+
+    // One piece of a runAll() call; lives on the forking thread's stack
+    class ChunkTask : public Task {
+    public:
+        ChunkTask(const std::function<void(size_t)>& body, size_t index, std::atomic<size_t>& remaining)
+            : body(&body), index(index), remaining(&remaining) {}
+
+        void execute() override {
+            (*body)(index);
+        }
+
+        // Signals completion; the forking thread may free this chunk right after, so this is last
+        void release() override {
+            remaining->fetch_sub(1, std::memory_order_acq_rel);
+        }
+
+    private:
+        const std::function<void(size_t)>* body;
+        size_t index;
+        std::atomic<size_t>* remaining;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<bool> stop;
+    std::atomic<int> sleepers;
+    std::atomic<size_t> nextInbox;
+    size_t numWorkers;
+    size_t backgroundLimit;
+    std::mutex backgroundMutex;
+    std::deque<Task*> background;  // Background lane, shared by all workers
+    std::atomic<size_t> backgroundSize;
+    std::atomic<size_t> backgroundRunning;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+
+    static int& currentWorkerIndex() {
+        thread_local int index = -1;
+        return index;
+    }
+
+    static ThreadPool*& workerPool() {
+        thread_local ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    static void pin(std::thread& thread, size_t index) {
+        unsigned cpus = std::thread::hardware_concurrency();
+        if (cpus == 0)
+            return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(index % cpus, &set);
+        if (pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) != 0)
+            perror("pthread_setaffinity_np failed");
+    }
+
+    void workerLoop(size_t self) {
+        currentWorkerIndex() = int(self);
+        workerPool() = this;
+        currentParallelExecutor() = this;
+
+        while (true) {
+            Task* task = findWork(self);
+            if (task) {
+                runTask(task);
+                continue;
+            }
+            if (Task* task = takeBackground()) {
+                runTask(task);
+                finishBackground();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepers.fetch_add(1, std::memory_order_seq_cst);
+            // Re-check under the lock: a producer that saw sleepers > 0 must notify after this
+            if (!stop.load() && !hasWork())
+                wake.wait(lock);
+            sleepers.fetch_sub(1, std::memory_order_seq_cst);
+
+            if (stop.load() && !hasWork())
+                return;
+        }
+    }
+
+    static void runTask(Task* task) {
+        task->execute();
+        task->release();  // Clean up after task execution
+    }
+
+    // Own fork-join pieces, then interactive tasks anywhere, then pieces stolen from other workers
+    Task* findWork(size_t self) {
+        if (Task* task = workers[self]->local.pop())
+            return task;
+        if (Task* task = takeInbox(*workers[self], true))
+            return task;
+        for (size_t k = 1; k < numWorkers; ++k) {
+            if (Task* task = takeInbox(*workers[(self + k) % numWorkers], false))
+                return task;
+        }
+        return stealLocal(self);
+    }
+
+    bool backgroundAvailable() const {
+        return backgroundSize.load(std::memory_order_seq_cst) > 0 &&
+               backgroundRunning.load(std::memory_order_seq_cst) < backgroundLimit;
+    }
+
+    Task* takeBackground() {
+        if (!backgroundAvailable())
+            return nullptr;
+        std::lock_guard<std::mutex> lock(backgroundMutex);
+        if (background.empty() || backgroundRunning.load() >= backgroundLimit)
+            return nullptr;
+        Task* task = background.front();
+        background.pop_front();
+        backgroundSize.fetch_sub(1, std::memory_order_seq_cst);
+        backgroundRunning.fetch_add(1, std::memory_order_seq_cst);
+        return task;
+    }
+
+    // A background slot opened up: a worker that slept because the lane was full may take the next
+    void finishBackground() {
+        backgroundRunning.fetch_sub(1, std::memory_order_seq_cst);
+        if (backgroundSize.load(std::memory_order_seq_cst) > 0)
+            wakeOne();
+    }
+
+    Task* stealLocal(size_t self) {
+        for (size_t k = 1; k < numWorkers; ++k) {
+            if (Task* task = workers[(self + k) % numWorkers]->local.steal())
+                return task;
+        }
+        return nullptr;
+    }
+
+    // Owners pop from the front; thieves only try the lock so they never queue behind the owner
+    Task* takeInbox(Worker& worker, bool owner) {
+        if (worker.inboxSize.load(std::memory_order_acquire) == 0)
+            return nullptr;
+        std::unique_lock<std::mutex> lock(worker.inboxMutex, std::defer_lock);
+        if (owner)
+            lock.lock();
+        else if (!lock.try_lock())
+            return nullptr;
+        if (worker.inbox.empty())
+            return nullptr;
+        Task* task = worker.inbox.front();
+        worker.inbox.pop_front();
+        worker.inboxSize.fetch_sub(1, std::memory_order_release);
+        return task;
+    }
+
+    bool hasWork() const {
+        for (const auto& worker : workers) {
+            if (worker->inboxSize.load(std::memory_order_acquire) > 0 || !worker->local.empty())
+                return true;
+        }
+        return backgroundAvailable();
+    }
+
+    void wakeOne() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            wake.notify_one();
+        }
+    }
+
+    void wakeAll() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            wake.notify_all();
+        }
+    }
+};
+
+// Fixed-type object recycler: released objects are destroyed but their storage is kept on a
+// free list and reused by the next acquire(), so steady-state task creation does not hit malloc.
+// Each thread keeps its own free list and touches the shared one only in batches: to refill when
+// its list runs dry (e.g. the thread that creates tasks) and to hand slots back when it overflows
+// (e.g. a worker that finishes them), so most acquire() and release() calls take no lock. The
+// per-thread lists belong to T, not to a pool: every slot has the size of a T, so any pool of T can
+// reuse it, and a thread's slots are freed when the thread exits.
+template <typename T>
+class ObjectPool {
+public:
+    static constexpr size_t LocalLimit = 64;  // Per-thread free list limit
+    static constexpr size_t Batch = 32;       // Slots moved to or from the shared list at once
+
+    ~ObjectPool() {
+        for (void* slot : sharedSlots)
+            ::operator delete(slot);
+    }
+
+    template <typename... Args>
+    T* acquire(Args&&... args) {
+        std::vector<void*>& slots = localList().slots;
+        if (slots.empty()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t take = std::min(Batch, sharedSlots.size());
+            slots.insert(slots.end(), sharedSlots.end() - take, sharedSlots.end());
+            sharedSlots.resize(sharedSlots.size() - take);
+        }
+        void* slot;
+        if (slots.empty()) {
+            slot = ::operator new(sizeof(T));
+        } else {
+            slot = slots.back();
+            slots.pop_back();
+        }
+        try {
+            return new (slot) T(std::forward<Args>(args)...);
+        } catch (...) {
+            recycle(slot);
+            throw;
+        }
+    }
+
+    void release(T* object) {
+        object->~T();
+        recycle(object);
+    }
+
+private:
+    struct LocalList {
+        std::vector<void*> slots;
+
+        ~LocalList() {
+            for (void* slot : slots)
+                ::operator delete(slot);
+        }
+    };
+
+    std::mutex mutex;
+    std::vector<void*> sharedSlots;
+
+    static LocalList& localList() {
+        thread_local LocalList local;
+        return local;
+    }
+
+    void recycle(void* slot) {
+        std::vector<void*>& slots = localList().slots;
+        slots.push_back(slot);
+        if (slots.size() > LocalLimit) {
+            std::lock_guard<std::mutex> lock(mutex);
+            sharedSlots.insert(sharedSlots.end(), slots.end() - Batch, slots.end());
+            slots.resize(slots.size() - Batch);
+        }
+    }
+};
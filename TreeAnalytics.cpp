@@ -0,0 +1,181 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "IMSTSolver.cpp"
+
+// Linear-time analytics over a weighted forest (e.g. a minimum spanning forest).
+// The forest is stored as contiguous CSR arrays and walked twice, without recursion:
+//  1. an explicit-stack DFS from every unvisited vertex records the preorder, each vertex's parent,
+//     the weight of its parent edge, its depth and its distance from the root;
+//  2. the preorder walked backwards visits children before parents, which accumulates subtree
+//     sizes and the longest downward path of every vertex. Joining the two longest downward paths
+//     at a vertex gives the diameter, and each edge contributes weight * size * (component - size)
+//     to the sum of all pairwise distances.
+// All queries are O(1) afterwards; LCAIndex builds point-to-point distances on top of this.
+class TreeAnalytics {
+public:
+    TreeAnalytics(int numVertices, const std::vector<WeightedEdge>& edges)
+        : n(numVertices), offsets(numVertices + 1, 0), weightSum(0.0), diameterLength(0.0), pairDistanceSum(0.0),
+          pairs(0) {
+        for (const WeightedEdge& edge : edges) {
+            checkVertex(edge.u);
+            checkVertex(edge.v);
+            offsets[edge.u + 1]++;
+            offsets[edge.v + 1]++;
+            weightSum += edge.weight;
+        }
+        for (int i = 0; i < n; ++i)
+            offsets[i + 1] += offsets[i];
+        neighbors.resize(offsets[n]);
+        neighborWeights.resize(offsets[n]);
+        std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+        for (const WeightedEdge& edge : edges) {
+            neighbors[fill[edge.u]] = edge.v;
+            neighborWeights[fill[edge.u]++] = edge.weight;
+            neighbors[fill[edge.v]] = edge.u;
+            neighborWeights[fill[edge.v]++] = edge.weight;
+        }
+
+        traverse();
+        accumulate();
+    }
+
+    int numVertices() const {
+        return n;
+    }
+
+    double totalWeight() const {
+        return weightSum;
+    }
+
+    // Heaviest path between any two vertices of the same tree
+    double diameter() const {
+        return diameterLength;
+    }
+
+    // Sum of the distances over all unordered pairs of vertices in the same tree
+    double sumOfDistances() const {
+        return pairDistanceSum;
+    }
+
+    uint64_t connectedPairs() const {
+        return pairs;
+    }
+
+    // Average distance over all pairs of vertices in the same tree (0 if there are none)
+    double averageDistance() const {
+        return pairs > 0 ? pairDistanceSum / double(pairs) : 0.0;
+    }
+
+    // Traversal results, for indexes built on top of this one
+    const std::vector<int>& preorder() const {
+        return order;
+    }
+
+    int parentOf(int u) const {
+        return parent[u];
+    }
+
+    int rootOf(int u) const {
+        return root[u];
+    }
+
+    int depthOf(int u) const {
+        return depth[u];
+    }
+
+    double distanceFromRoot(int u) const {
+        return rootDistance[u];
+    }
+
+    template <typename Fn>
+    void forEachNeighbor(int u, Fn&& fn) const {
+        for (size_t i = offsets[u]; i < offsets[u + 1]; ++i)
+            fn(neighbors[i], neighborWeights[i]);
+    }
+
+private:
+    int n;
+    std::vector<size_t> offsets;
+    std::vector<int> neighbors;
+    std::vector<double> neighborWeights;
+
+    std::vector<int> order;  // DFS preorder, one tree after another
+    std::vector<int> parent;
+    std::vector<int> root;
+    std::vector<int> depth;
+    std::vector<double> parentWeight;
+    std::vector<double> rootDistance;
+
+    double weightSum;
+    double diameterLength;
+    double pairDistanceSum;
+    uint64_t pairs;
+
+    void checkVertex(int u) const {
+        if (u < 0 || u >= n)
+            throw std::out_of_range("Vertex out of range.");
+    }
+
+    // Pass 1
+    void traverse() {
+        order.reserve(n);
+        parent.assign(n, -1);
+        root.assign(n, -1);
+        depth.assign(n, 0);
+        parentWeight.assign(n, 0.0);
+        rootDistance.assign(n, 0.0);
+
+        std::vector<int> stack;
+        for (int r = 0; r < n; ++r) {
+            if (root[r] != -1)
+                continue;
+            root[r] = r;
+            stack.push_back(r);
+            while (!stack.empty()) {
+                int u = stack.back();
+                stack.pop_back();
+                order.push_back(u);
+                for (size_t i = offsets[u]; i < offsets[u + 1]; ++i) {
+                    int v = neighbors[i];
+                    if (root[v] != -1)
+                        continue;  // The parent (the input is a forest, so nothing else is seen twice)
+                    root[v] = r;
+                    parent[v] = u;
+                    depth[v] = depth[u] + 1;
+                    parentWeight[v] = neighborWeights[i];
+                    rootDistance[v] = rootDistance[u] + neighborWeights[i];
+                    stack.push_back(v);
+                }
+            }
+        }
+    }
+
+    // Pass 2
+    void accumulate() {
+        std::vector<uint64_t> subtreeSize(n, 1);
+        std::vector<double> down(n, 0.0);  // Longest path from a vertex down into its subtree
+        for (size_t i = order.size(); i-- > 0;) {
+            int u = order[i];
+            int p = parent[u];
+            if (p == -1)
+                continue;
+            double through = down[u] + parentWeight[u];
+            diameterLength = std::max(diameterLength, down[p] + through);
+            down[p] = std::max(down[p], through);
+            subtreeSize[p] += subtreeSize[u];
+        }
+
+        for (int u = 0; u < n; ++u) {
+            if (parent[u] == -1) {
+                uint64_t size = subtreeSize[u];
+                pairs += size * (size - 1) / 2;
+            } else {
+                uint64_t below = subtreeSize[u], above = subtreeSize[root[u]] - below;
+                pairDistanceSum += parentWeight[u] * double(below) * double(above);
+            }
+        }
+    }
+};
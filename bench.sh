@@ -0,0 +1,13 @@
+#!/bin/bash
+
+# Step 1: Compile the benchmark with the same optimization level as the server
+g++ -std=c++17 -O2 -pthread -o mst_bench Benchmark.cpp || exit 1
+
+# Step 2: Run the sweep; extra arguments go to the benchmark (e.g. --baseline bench-old.json)
+OUTPUT="bench-$(git rev-parse --short HEAD 2> /dev/null || date +%s).json"
+./mst_bench "$@" > "$OUTPUT"
+STATUS=$?
+
+# Step 3: Report; a non-zero status means a weight mismatch (1) or a regression (2)
+echo "Benchmark results written to $OUTPUT"
+exit $STATUS
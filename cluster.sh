@@ -0,0 +1,23 @@
+#!/bin/bash
+
+# Runs a coordinator on port 8080 with N local worker servers on ports 9001.. (default 3).
+# Workers are plain MSTServer processes, so remote machines can take their place by passing
+# their host:port list to --workers instead.
+WORKERS=${1:-3}
+THREADS=${THREADS:-2}
+
+# Step 1: Compile the server
+g++ -std=c++17 -O2 -pthread -o mst_server MSTServer.cpp || exit 1
+
+# Step 2: Start the workers
+LIST=""
+for ((i = 1; i <= WORKERS; i++)); do
+    PORT=$((9000 + i))
+    ./mst_server --threads "$THREADS" --port "$PORT" > "worker_$PORT.log" 2>&1 &
+    LIST="$LIST${LIST:+,}127.0.0.1:$PORT"
+done
+trap 'kill $(jobs -p) 2> /dev/null' EXIT
+
+# Step 3: Run the coordinator in the foreground until interrupted
+echo "Coordinator on port 8080, workers $LIST"
+./mst_server --threads "$THREADS" --workers "$LIST"